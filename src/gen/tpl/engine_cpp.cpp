@@ -0,0 +1,976 @@
+/*
+**	This file was generated by the RedStar Pegasus tool.
+*/
+
+#ifndef __engine_$0_h
+#define __engine_$0_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace $0
+{
+    /**
+     * @brief Describes a token, that is a string obtained from a data source that belongs to a certain token group which gives it meaning.
+     */
+    class Token
+    {
+        protected:
+
+        /**
+         * @brief String value of the token.
+         */
+        char *value;
+
+        /**
+         * @brief Length of the token's value.
+         */
+        int length;
+
+        /**
+         * @brief Type of the token.
+         */
+        int type;
+
+        /**
+         * @brief Name of the data source of the token.
+         */
+        const char *source;
+
+        /**
+         * @brief Line and column numbers.
+         */
+        unsigned line, col;
+
+        public:
+
+        /**
+         * @brief Initializes the token object with the specified parameters.
+         *
+         * @param source Data source name.
+         * @param value Token value.
+         * @param length Length.
+         * @param type Token type.
+         * @param line Line number.
+         * @param col Column number.
+         */
+        Token (const char *source, const char *value, int length, int type, int line, int col)
+        {
+            this->value = (char *)new char[length+1];
+            this->length = length;
+            this->type = type;
+
+            this->source = source;
+            this->line = line;
+            this->col = col;
+
+            memcpy (this->value, value, length);
+            this->value[length] = '\0';
+        }
+
+        /**
+         * @brief Destroys the token and its related value. To prevent value from being deleted use `getValue(true)` or `acquireValue`.
+         */
+        virtual ~Token ()
+        {
+            if (this->value != nullptr)
+                delete[] this->value;
+        }
+
+        /**
+         * @brief Changes the type of the token.
+         * @param type
+         * @return Token*
+         */
+        Token *setType (int type)
+        {
+            this->type = type;
+            return this;
+        }
+
+        /**
+         * @brief Compares the token value against the given string and returns true if they match.
+         * @param value
+         * @return bool
+         */
+        bool equals (const char *value) const
+        {
+            if (value == nullptr || (int)strlen(value) != length)
+                return false;
+
+            return !memcmp (this->value, value, length);
+        }
+
+        /**
+         * @brief Returns the string value of the token. If the `preserve` parameter is set to `true` the underlying string will
+         * not be deleted upon destruction of the token.
+         *
+         * @param preserve
+         * @return char*
+         */
+        char *getValue (bool preserve=false)
+        {
+            char *value = this->value;
+
+            if (preserve)
+                this->value = nullptr;
+
+            return value;
+        }
+
+        /**
+         * @brief Returns the string value of the token and removes the internal reference to it to prevent deallocation. By default
+         * the object is destroyed afterwards but that can be prevented by setting the `selfDestruct` parameter to `false`.
+         *
+         * @param selfDestruct
+         * @return char*
+         */
+        char *acquireValue (bool selfDestruct=true)
+        {
+            char *value = this->value;
+            this->value = nullptr;
+
+            if (selfDestruct)
+                delete this;
+
+            return value;
+        }
+
+        /**
+         * @brief Returns the length of the value of the token.
+         * @return int
+         */
+        int getLength() const {
+            return this->length;
+        }
+
+        /**
+         * @brief Returns the token type.
+         * @return int
+         */
+        int getType() const {
+            return this->type;
+        }
+
+        /**
+         * @brief Returns the source name.
+         * @return const char*
+         */
+        const char *getSource() const {
+            return this->source;
+        }
+
+        /**
+         * @brief Returns the column number where the token appears in the source.
+         * @return int
+         */
+        int getCol() const {
+            return this->col;
+        }
+
+        /**
+         * @brief Returns the line number where the token appears in the source.
+         * @return int
+         */
+        int getLine() const {
+            return this->line;
+        }
+    };
+
+    /**
+     * @brief Grammar tables written by psxt with the `bin` output format. The file is mapped in memory and used in place: every
+     * reference inside it is a byte offset and every value a 32-bit little-endian word, so loading only checks the header.
+     */
+    class Grammar
+    {
+        public:
+
+        /**
+         * @brief Signature ("PSXT") and format version of the file.
+         */
+        static const int32_t MAGIC = 0x54585350;
+        static const int32_t VERSION = 1;
+
+        /**
+         * @brief Fields of the file header, pairs of fields give the number of records and the offset of a table.
+         */
+        enum Header
+        {
+            MAGIC_FIELD, FORMAT, SIZE, NUM_SYMBOLS, SYMBOLS, NUM_ARRAYS, ARRAYS, NUM_SCANNER_STATES, SCANNER_STATES,
+            NUM_PARSER_STATES, PARSER_STATES, NUM_RULES, RULES, STRINGS, HEADER_SIZE
+        };
+
+        /**
+         * @brief Number of words of the records of each table.
+         */
+        static const int SCANNER_STATE_SIZE = 257 + 6;
+        static const int PARSER_STATE_SIZE = 6;
+        static const int RULE_SIZE = 6;
+        static const int ARRAY_SIZE = 4;
+
+        protected:
+
+        /**
+         * @brief Contents of the file and its size in bytes.
+         */
+        const char *data;
+        size_t size;
+
+        /**
+         * @brief Indicates if the data was mapped by this object (and must be unmapped).
+         */
+        bool mapped;
+
+        /**
+         * @brief Indicates if the header of the file is valid.
+         */
+        bool valid;
+
+        /**
+         * @brief Returns a field of the header without checking that the tables are valid.
+         * @param i
+         * @return int32_t
+         */
+        int32_t field (int i) const {
+            return ((const int32_t *)data)[i];
+        }
+
+        /**
+         * @brief Checks the header and the bounds of the tables.
+         */
+        void validate ()
+        {
+            valid = false;
+
+            if (data == nullptr || size < HEADER_SIZE * 4 || ((uintptr_t)data & 3) != 0)
+                return;
+
+            if (field(MAGIC_FIELD) != MAGIC || field(FORMAT) != VERSION || (size_t)field(SIZE) != size)
+                return;
+
+            const int32_t tables[][3] = {
+                { NUM_SYMBOLS, SYMBOLS, 1 }, { NUM_ARRAYS, ARRAYS, ARRAY_SIZE }, { NUM_SCANNER_STATES, SCANNER_STATES, SCANNER_STATE_SIZE },
+                { NUM_PARSER_STATES, PARSER_STATES, PARSER_STATE_SIZE }, { NUM_RULES, RULES, RULE_SIZE }
+            };
+
+            for (int i = 0; i < 5; i++)
+            {
+                int64_t count = field(tables[i][0]), offset = field(tables[i][1]);
+
+                if (count < 0 || offset < 0 || offset + count * tables[i][2] * 4 > (int64_t)size)
+                    return;
+            }
+
+            if (field(STRINGS) < 0 || (size_t)field(STRINGS) > size || field(NUM_SCANNER_STATES) < 2 || field(NUM_PARSER_STATES) < 2)
+                return;
+
+            valid = true;
+        }
+
+        public:
+
+        /**
+         * @brief Maps the tables from the specified file.
+         * @param filepath
+         */
+        Grammar (const char *filepath)
+        {
+            this->data = nullptr;
+            this->size = 0;
+            this->mapped = false;
+
+            int fd = open (filepath, O_RDONLY);
+            struct stat st;
+
+            if (fd != -1 && fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                void *ptr = mmap (nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+                if (ptr != MAP_FAILED)
+                {
+                    this->data = (const char *)ptr;
+                    this->size = st.st_size;
+                    this->mapped = true;
+                }
+            }
+
+            if (fd != -1)
+                close (fd);
+
+            validate ();
+        }
+
+        /**
+         * @brief Uses the tables stored in the given buffer (4-byte aligned), the buffer is not copied and must outlive the object.
+         * @param data
+         * @param size
+         */
+        Grammar (const void *data, size_t size)
+        {
+            this->data = (const char *)data;
+            this->size = size;
+            this->mapped = false;
+
+            validate ();
+        }
+
+        /**
+         * @brief Releases the mapping of the file.
+         */
+        ~Grammar ()
+        {
+            if (mapped)
+                munmap ((void *)data, size);
+        }
+
+        /**
+         * @brief Returns `true` if the tables were loaded and the header is valid.
+         * @return bool
+         */
+        bool isValid () const {
+            return valid;
+        }
+
+        /**
+         * @brief Returns a field of the header, or zero if the tables are not valid.
+         * @param i
+         * @return int32_t
+         */
+        int32_t header (int i) const {
+            return valid ? field(i) : 0;
+        }
+
+        /**
+         * @brief Returns the words located at the given byte offset.
+         * @param offset
+         * @return const int32_t*
+         */
+        const int32_t *at (int32_t offset) const {
+            return (const int32_t *)(data + offset);
+        }
+
+        /**
+         * @brief Returns a string of the string pool.
+         * @param offset
+         * @return const char*
+         */
+        const char *string (int32_t offset) const {
+            return data + header(STRINGS) + offset;
+        }
+
+        /**
+         * @brief Returns the record of a scanner state: next state for each byte (index 256 for EOF), followed by the non-terminal,
+         * length, kind and token code of the reduction, and the offset and count of the GOTO table.
+         * @param state
+         * @return const int32_t*
+         */
+        const int32_t *getScannerState (int state) const {
+            return state > 0 && state < header(NUM_SCANNER_STATES) ? at(header(SCANNER_STATES) + state * SCANNER_STATE_SIZE * 4) : nullptr;
+        }
+
+        /**
+         * @brief Returns the record of a parser state: offset and count of its shifts (symbol, value and next state), reductions
+         * (rule, offset and count of the lookaheads) and GOTO actions (non-terminal and next state).
+         * @param state
+         * @return const int32_t*
+         */
+        const int32_t *getParserState (int state) const {
+            return state > 0 && state < header(NUM_PARSER_STATES) ? at(header(PARSER_STATES) + state * PARSER_STATE_SIZE * 4) : nullptr;
+        }
+
+        /**
+         * @brief Returns the record of a rule: non-terminal ID, rule ID, length, number of values, element passed through as value
+         * and name of the non-terminal (`nullptr` if out of bounds).
+         * @param rule
+         * @return const int32_t*
+         */
+        const int32_t *getRule (int rule) const {
+            return rule >= 0 && rule < header(NUM_RULES) ? at(header(RULES) + rule * RULE_SIZE * 4) : nullptr;
+        }
+
+        /**
+         * @brief Returns the number of rules, this is the size of the table of actions of the engine (zero if the tables are not
+         * valid).
+         * @return int
+         */
+        int getRuleCount () const {
+            return header(NUM_RULES);
+        }
+
+        /**
+         * @brief Returns the index of the rule with the given ID (starting at 1) of a non-terminal, or -1 if not found.
+         * @param name
+         * @param id
+         * @return int
+         */
+        int findRule (const char *name, int id) const
+        {
+            for (int i = 0; i < getRuleCount(); i++)
+                if (getRule(i)[1] == id && !strcmp(string(getRule(i)[5]), name)) return i;
+
+            return -1;
+        }
+
+        /**
+         * @brief Returns the name of the non-terminal of a rule (`nullptr` if out of bounds).
+         * @param rule
+         * @return const char*
+         */
+        const char *getRuleName (int rule) const {
+            return getRule(rule) != nullptr ? string(getRule(rule)[5]) : nullptr;
+        }
+
+        /**
+         * @brief Returns the token type of the given symbol name, or -1 if not found.
+         * @param name
+         * @return int
+         */
+        int getSymbol (const char *name) const
+        {
+            for (int i = 0; i < header(NUM_SYMBOLS); i++)
+                if (!strcmp(string(at(header(SYMBOLS))[i]), name)) return i + 256;
+
+            return -1;
+        }
+
+        /**
+         * @brief Returns the name of a token type.
+         * @param type
+         * @return const char*
+         */
+        const char *getSymbolName (int type) const {
+            return type >= 256 && type - 256 < header(NUM_SYMBOLS) ? string(at(header(SYMBOLS))[type - 256]) : nullptr;
+        }
+    };
+
+    /**
+     * @brief Scanner running the lexicon state machine of a grammar on an in-memory source.
+     */
+    class Lexer
+    {
+        protected:
+
+        /**
+         * @brief Grammar tables.
+         */
+        const Grammar *grammar;
+
+        /**
+         * @brief Name of the source, read pointer and end of the source.
+         */
+        const char *source;
+        const unsigned char *ip, *ie;
+
+        /**
+         * @brief Scanner context details.
+         */
+        int state, shift, symbol, linenum, colnum, error;
+
+        /**
+         * @brief Scanner stack.
+         */
+        int *stack, sp, stackSize;
+
+        /**
+         * @brief Buffer for the last token parsed and its size.
+         */
+        char *value;
+        int valueSize;
+
+        /**
+         * @brief Doubles the size of the token buffer and returns the write pointer relocated to the new buffer.
+         * @param bp
+         * @return char*
+         */
+        char *grow (char *bp)
+        {
+            char *temp = new char[valueSize * 2];
+            memcpy (temp, value, bp - value);
+
+            bp = temp + (bp - value);
+
+            delete[] value;
+            value = temp;
+            valueSize *= 2;
+
+            return bp;
+        }
+
+        /**
+         * @brief Translates a token to an array-token if the token code matches the array composition code.
+         * @param token
+         * @return Token*
+         */
+        Token *translate (Token *token)
+        {
+            const int32_t *arrays = grammar->at(grammar->header(Grammar::ARRAYS));
+
+            for (int i = 0; i < grammar->header(Grammar::NUM_ARRAYS); i++, arrays += Grammar::ARRAY_SIZE)
+            {
+                if (token->getType() != arrays[0])
+                    continue;
+
+                const int32_t *strings = grammar->at(arrays[2]);
+
+                for (int j = 0; j < arrays[3]; j++)
+                    if (token->equals(grammar->string(strings[j]))) return token->setType(arrays[1]);
+            }
+
+            return token;
+        }
+
+        public:
+
+        /**
+         * @brief Initializes the scanner.
+         * @param grammar Grammar tables.
+         * @param source Name of the source.
+         * @param data Source data, must outlive the scanner.
+         * @param length Length of the data.
+         * @param stackSize Scanner stack size (default is 1024).
+         */
+        Lexer (const Grammar *grammar, const char *source, const char *data, unsigned long length, int stackSize=1024)
+        {
+            this->grammar = grammar;
+            this->source = source;
+
+            this->ip = (const unsigned char *)data;
+            this->ie = this->ip + length;
+
+            this->state = 1;
+            this->shift = 1;
+            this->symbol = -1;
+            this->error = 0;
+
+            this->linenum = 1;
+            this->colnum = 1;
+
+            this->stack = new int[stackSize];
+            this->stackSize = stackSize;
+            this->sp = 0;
+
+            this->value = new char[this->valueSize = 1024];
+        }
+
+        /**
+         * @brief Releases all allocated data.
+         */
+        ~Lexer ()
+        {
+            delete[] this->stack;
+            delete[] this->value;
+        }
+
+        /**
+         * @brief Returns `true` if an invalid byte sequence was found.
+         * @return bool
+         */
+        bool hasError () const {
+            return error != 0;
+        }
+
+        /**
+         * @brief Scans and returns the next token, a type -1 (EOF) token is returned at the end of the source or on error.
+         * @return Token*
+         */
+        Token *nextToken ()
+        {
+            int reduce=0, state=this->state, shift=this->shift, symbol=this->symbol;
+            int nonterm=0, release=0, code=0;
+            int _colnum=this->colnum, _linenum=this->linenum;
+
+            int *stack = this->stack, sp = this->sp;
+            char *bp = this->value;
+
+            while (!error)
+            {
+                if (shift)
+                {
+                    if (symbol != -1)
+                    {
+                        if (bp == this->value + valueSize - 1) bp = grow(bp);
+                        *bp++ = symbol;
+                        colnum++;
+
+                        if (symbol == '\n')
+                        {
+                            colnum = 1;
+                            linenum++;
+                        }
+                    }
+
+                    symbol = ip != ie ? *ip++ : -1;
+                    shift = 0;
+                }
+
+                if (reduce)
+                {
+                    if (nonterm == 0)
+                        break;
+
+                    state = stack[sp -= release];
+
+                    if (reduce == 3)
+                    {
+                        _linenum = linenum;
+                        _colnum = colnum;
+
+                        bp = this->value;
+                    }
+
+                    if (reduce == 2)
+                    {
+                        // The state is pushed again when scanning resumes.
+                        this->sp = sp - 1;
+                        this->state = state;
+                        this->shift = shift;
+                        this->symbol = symbol;
+
+                        return translate (new Token (source, this->value, (int)(bp - this->value), code, _linenum, _colnum));
+                    }
+                }
+                else
+                {
+                    if (sp == stackSize-1) { error = 1; continue; }
+                    stack[++sp] = state;
+                }
+
+                const int32_t *s = grammar->getScannerState(state);
+                if (s == nullptr) { error = 1; continue; }
+
+                if (reduce)
+                {
+                    const int32_t *gotos = grammar->at(s[261]);
+                    int i;
+
+                    for (i = 0; i < s[262] && gotos[2*i] != nonterm; i++);
+                    if (i == s[262]) { error = 1; continue; }
+
+                    state = gotos[2*i+1];
+                    reduce = 0;
+                    continue;
+                }
+
+                if (s[symbol != -1 ? symbol : 256] != 0)
+                {
+                    state = s[symbol != -1 ? symbol : 256];
+                    shift = 1;
+                    continue;
+                }
+
+                if (s[259] == 0) { error = 1; continue; }
+
+                nonterm = s[257];
+                release = s[258];
+                reduce = s[259];
+                code = s[260];
+            }
+
+            return new Token (source, "", 0, -1, _linenum, _colnum);
+        }
+    };
+
+    /**
+     * @brief Action of a rule, receives the parser context and the values of the elements of the rule, and returns the value of
+     * the rule. Tokens among the values are released after the action returns, use `getValue(true)` to keep their string.
+     */
+    typedef void *(*Action) (void *context, void **argv, int argc);
+
+    /**
+     * @brief Generic parser running the grammar state machine of a set of tables. Actions are dispatched through a table indexed
+     * by rule (see `Grammar::findRule`), rules without an action pass through the value of the element their action refers to
+     * when it is just a marker, or have a null value otherwise.
+     */
+    class Engine
+    {
+        protected:
+
+        /**
+         * @brief Grammar tables.
+         */
+        const Grammar *grammar;
+
+        /**
+         * @brief Actions indexed by rule, not owned by the engine.
+         */
+        Action *actions;
+
+        /**
+         * @brief Parser stack.
+         */
+        int *stack, stackSize;
+
+        /**
+         * @brief Current production rule values, and flags of the values that are tokens.
+         */
+        void **argv;
+        bool *tokens;
+
+        /**
+         * @brief Error flag of the last parse.
+         */
+        int error;
+
+        /**
+         * @brief Returns `true` if the lookahead matches any of the given conditions (symbol and value offset, -1 if not checked).
+         * @param follow
+         * @param count
+         * @param token
+         * @return bool
+         */
+        bool matches (const int32_t *follow, int count, Token *token)
+        {
+            for (int i = 0; i < count; i++, follow += 2)
+                if (follow[0] == token->getType() && (follow[1] == -1 || token->equals(grammar->string(follow[1])))) return true;
+
+            return false;
+        }
+
+        public:
+
+        /**
+         * @brief Initializes the engine.
+         * @param grammar Grammar tables.
+         * @param actions Actions indexed by rule (`grammar->getRuleCount()` entries, null entries allowed).
+         * @param stackSize Parser stack size (default: 1024).
+         */
+        Engine (const Grammar *grammar, Action *actions, int stackSize=1024)
+        {
+            this->grammar = grammar;
+            this->actions = actions;
+
+            this->stack = new int[stackSize];
+            this->stackSize = stackSize;
+
+            this->argv = new void*[stackSize];
+            this->tokens = new bool[stackSize];
+            this->error = 0;
+        }
+
+        /**
+         * @brief Releases resources.
+         */
+        ~Engine ()
+        {
+            delete[] this->stack;
+            delete[] this->argv;
+            delete[] this->tokens;
+        }
+
+        /**
+         * @brief Returns `true` if the last parse failed.
+         * @return bool
+         */
+        bool hasError () const {
+            return error != 0;
+        }
+
+        /**
+         * @brief Parses the tokens of the given scanner and returns the value of the start rule.
+         * @param lexer Scanner to obtain tokens.
+         * @param context Context passed to the actions.
+         * @return void*
+         */
+        void *parse (Lexer *lexer, void *context=nullptr)
+        {
+            int state=1, reduce=0, shift=1, symbol=-1;
+            int nonterm=0, release=0, shifted=0, bp=0, sp=0;
+
+            Token *token = nullptr;
+            error = 0;
+
+            if (!grammar->isValid())
+            {
+                error = 1;
+                return nullptr;
+            }
+
+            while (1)
+            {
+                if (error)
+                    break;
+
+                if (shift)
+                {
+                    if (token != nullptr)
+                    {
+                        if (bp == stackSize) { error = 1; continue; }
+
+                        tokens[bp] = true;
+                        argv[bp++] = token;
+                    }
+
+                    token = lexer->nextToken();
+                    symbol = token->getType();
+                    shift = 0;
+                }
+
+                if (reduce)
+                {
+                    if (nonterm == 0)
+                        break;
+
+                    state = stack[sp -= release];
+                    bp -= shifted - 1;
+                }
+                else
+                {
+                    if (sp == stackSize-1) { error = 1; continue; }
+                    stack[++sp] = state;
+                }
+
+                const int32_t *s = grammar->getParserState(state);
+                if (s == nullptr) { error = 1; continue; }
+
+                if (reduce)
+                {
+                    const int32_t *gotos = grammar->at(s[4]);
+                    int i;
+
+                    for (i = 0; i < s[5] && gotos[2*i] != nonterm; i++);
+                    if (i == s[5]) { error = 1; continue; }
+
+                    state = gotos[2*i+1];
+                    reduce = 0;
+                    continue;
+                }
+
+                // Reductions with lookaheads come first, then shifts, and the default reduction (if any) is taken last.
+                const int32_t *reductions = grammar->at(s[2]);
+                int rule = -1, defaultRule = -1;
+
+                for (int i = 0; i < s[3] && rule == -1; i++, reductions += 3)
+                {
+                    if (reductions[2] == 0)
+                        defaultRule = reductions[0];
+                    else if (matches(grammar->at(reductions[1]), reductions[2], token))
+                        rule = reductions[0];
+                }
+
+                if (rule == -1)
+                {
+                    const int32_t *shifts = grammar->at(s[0]);
+
+                    for (int i = 0; i < s[1]; i++, shifts += 3)
+                    {
+                        if (shifts[0] != symbol || (shifts[1] != -1 && !token->equals(grammar->string(shifts[1]))))
+                            continue;
+
+                        state = shifts[2];
+                        shift = 1;
+
+                        if (shifts[1] != -1) break;
+                    }
+
+                    if (shift) continue;
+                    if ((rule = defaultRule) == -1) { error = 1; continue; }
+                }
+
+                const int32_t *r = grammar->getRule(rule);
+                void *temp = nullptr;
+                bool isToken = false;
+
+                nonterm = r[0];
+                release = r[2];
+                shifted = r[3];
+                reduce = 1;
+
+                if (actions != nullptr && actions[rule] != nullptr)
+                {
+                    temp = actions[rule] (context, argv + bp - shifted, shifted);
+                }
+                else if (r[4] != -1)
+                {
+                    temp = argv[bp - shifted + r[4]];
+                    isToken = tokens[bp - shifted + r[4]];
+                    tokens[bp - shifted + r[4]] = false;
+                }
+
+                for (int i = bp - shifted; i < bp; i++)
+                {
+                    if (tokens[i]) delete (Token *)argv[i];
+                    tokens[i] = false;
+                }
+
+                argv[bp - shifted] = temp;
+                tokens[bp - shifted] = isToken;
+            }
+
+            for (int i = error ? 0 : 1; i < bp; i++)
+                if (tokens[i]) delete (Token *)argv[i];
+
+            if (token != nullptr) delete token;
+
+            return error ? nullptr : argv[0];
+        }
+
+        /**
+         * @brief Parses the given in-memory source and returns the value of the start rule.
+         * @param data Source data.
+         * @param length Length of the data.
+         * @param context Context passed to the actions.
+         * @param source Name of the source.
+         * @return void*
+         */
+        void *parse (const char *data, unsigned long length, void *context=nullptr, const char *source="")
+        {
+            Lexer lexer (grammar, source, data, length, stackSize);
+            void *value = parse (&lexer, context);
+
+            if (lexer.hasError())
+                error = 1;
+
+            return value;
+        }
+
+        /**
+         * @brief Maps the specified file in memory and returns the value of its start rule.
+         * @param filepath Path to the source file.
+         * @param context Context passed to the actions.
+         * @return void*
+         */
+        void *parseFile (const char *filepath, void *context=nullptr)
+        {
+            int fd = open (filepath, O_RDONLY);
+            struct stat st;
+            void *value = nullptr;
+
+            if (fd == -1 || fstat(fd, &st) != 0)
+            {
+                if (fd != -1) close (fd);
+
+                error = 1;
+                return nullptr;
+            }
+
+            if (st.st_size == 0)
+            {
+                close (fd);
+                return parse ("", 0, context, filepath);
+            }
+
+            void *ptr = mmap (nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close (fd);
+
+            if (ptr == MAP_FAILED)
+            {
+                error = 1;
+                return nullptr;
+            }
+
+            value = parse ((const char *)ptr, st.st_size, context, filepath);
+            munmap (ptr, st.st_size);
+
+            return value;
+        }
+    };
+};
+
+#endif
@@ -4,12 +4,896 @@
 
 #ifndef __parser_$0_h
 #define __parser_$0_h
+$D
 
 #include <stdio.h>
 #include <stdlib.h>
 
 namespace $0
 {
+$3
+#ifdef __parser_$0_tree
+#ifndef __scanner_$0_lazy_positions
+#define __parser_$0_incremental
+#endif
+
+    /**
+     * @brief Node of a syntax tree. Nodes are stored in postorder, so the children of a node precede it and the last child is
+     * the node right before it. Tokens are leaves with a non-terminal of -1.
+     */
+    struct TreeNode
+    {
+        /**
+         * @brief Non-terminal and rule (ID within the non-terminal) of the node, or -1 and the token type for a leaf.
+         */
+        int nonterm, rule;
+
+        /**
+         * @brief Parser state on top of the stack when the first symbol of the node was shifted.
+         */
+        int state;
+
+        /**
+         * @brief Number of children, and number of nodes of the subtree including this node.
+         */
+        int count, size;
+
+        /**
+         * @brief Index of the first token covered by the node, and index past the last one.
+         */
+        int first, last;
+    };
+
+    class Tree;
+
+    /**
+     * @brief Position on a syntax tree. Children are visited from the last to the first one, moving to the previous sibling
+     * skips the whole subtree of the current node with a single subtraction.
+     */
+    class TreeCursor
+    {
+        protected:
+
+        /**
+         * @brief Tree being traversed.
+         */
+        const Tree *tree;
+
+        /**
+         * @brief Index of the current node (-1 if not valid), and index of the first node of the subtree of its parent.
+         */
+        int index, start;
+
+        public:
+
+        /**
+         * @brief Initializes the cursor on the given node.
+         * @param tree
+         * @param index
+         * @param start
+         */
+        TreeCursor (const Tree *tree, int index, int start)
+        {
+            this->tree = tree;
+            this->index = index;
+            this->start = start;
+        }
+
+        /**
+         * @brief Returns `true` if the cursor is on a node.
+         * @return bool
+         */
+        bool isValid() const {
+            return index != -1;
+        }
+
+        /**
+         * @brief Returns the index of the current node.
+         * @return int
+         */
+        int getIndex() const {
+            return index;
+        }
+
+        /**
+         * @brief Returns the current node.
+         * @return const TreeNode*
+         */
+        inline const TreeNode *getNode() const;
+
+        /**
+         * @brief Returns `true` if the current node is a token.
+         * @return bool
+         */
+        bool isToken() const {
+            return getNode()->nonterm == -1;
+        }
+
+        /**
+         * @brief Returns the token of a leaf node, or the first token covered by the node (`nullptr` if none).
+         * @return Token*
+         */
+        inline Token *getToken() const;
+
+        /**
+         * @brief Returns the name of the non-terminal of the node (empty for a token).
+         * @return const char*
+         */
+        const char *getName() const {
+            return isToken() ? "" : treeNames[getNode()->nonterm];
+        }
+
+        /**
+         * @brief Returns a cursor on the last child of the node (not valid if the node has no children).
+         * @return TreeCursor
+         */
+        TreeCursor lastChild() const {
+            return TreeCursor (tree, getNode()->count ? index - 1 : -1, index - getNode()->size + 1);
+        }
+
+        /**
+         * @brief Returns a cursor on the previous sibling of the node (not valid if this is the first child).
+         * @return TreeCursor
+         */
+        TreeCursor prevSibling() const {
+            return TreeCursor (tree, index - getNode()->size >= start ? index - getNode()->size : -1, start);
+        }
+
+        /**
+         * @brief Returns a cursor on the i-th child of the node (not valid if out of bounds).
+         * @param i
+         * @return TreeCursor
+         */
+        TreeCursor child (int i) const
+        {
+            TreeCursor cursor = lastChild();
+
+            for (int j = getNode()->count - 1; j > i && cursor.isValid(); j--)
+                cursor = cursor.prevSibling();
+
+            return i >= 0 && i < getNode()->count ? cursor : TreeCursor (tree, -1, start);
+        }
+    };
+
+    /**
+     * @brief Concrete syntax tree stored as a contiguous array of nodes in postorder, built by the parser with one append per
+     * shift and reduction. The tree owns the tokens.
+     */
+    class Tree
+    {
+        protected:
+
+        /**
+         * @brief Nodes of the tree, number of nodes and capacity of the array.
+         */
+        TreeNode *nodes;
+        int length, capacity;
+
+        /**
+         * @brief Tokens of the tree, number of tokens and capacity of the array.
+         */
+        Token **tokens;
+        int numTokens, tokensCapacity;
+
+        /**
+         * @brief Offset in the source where each token ends. Scanning can be restarted at any of these offsets.
+         */
+        unsigned long *ends;
+
+        /**
+         * @brief Previous tree while reparsing. Its first `numKept` nodes and `numKeptTokens` tokens are the first ones of this
+         * tree and are kept in place, the arrays of this tree hold the ones after them until `merge` is called.
+         */
+        Tree *prev;
+        int numKept, numKeptTokens;
+
+        /**
+         * @brief Returns the i-th node, which can be one kept in place in the previous tree.
+         * @param i
+         * @return TreeNode*
+         */
+        TreeNode *at (int i) const {
+            return i < numKept ? &prev->nodes[i] : &nodes[i - numKept];
+        }
+
+        /**
+         * @brief Returns `count` new nodes at the end of the array.
+         * @param count
+         * @return TreeNode*
+         */
+        TreeNode *push (int count=1)
+        {
+            if (length - numKept + count > capacity)
+            {
+                while (length - numKept + count > capacity)
+                    capacity *= 2;
+
+                TreeNode *temp = new TreeNode[capacity];
+                memcpy (temp, nodes, (length - numKept) * sizeof(TreeNode));
+
+                delete[] nodes;
+                nodes = temp;
+            }
+
+            length += count;
+            return &nodes[length - count - numKept];
+        }
+
+        /**
+         * @brief Appends a token to the token array.
+         * @param token
+         * @param end
+         */
+        void add (Token *token, unsigned long end)
+        {
+            if (numTokens - numKeptTokens == tokensCapacity)
+            {
+                Token **temp = new Token*[tokensCapacity * 2];
+                unsigned long *temp2 = new unsigned long[tokensCapacity * 2];
+
+                memcpy (temp, tokens, tokensCapacity * sizeof(Token*));
+                memcpy (temp2, ends, tokensCapacity * sizeof(unsigned long));
+
+                delete[] tokens;
+                delete[] ends;
+
+                tokens = temp;
+                ends = temp2;
+                tokensCapacity *= 2;
+            }
+
+            tokens[numTokens - numKeptTokens] = token;
+            ends[numTokens++ - numKeptTokens] = end;
+        }
+
+        public:
+
+        /**
+         * @brief Initializes an empty tree, built by reparsing the source of `prev` when given.
+         * @param prev
+         */
+        Tree (Tree *prev=nullptr)
+        {
+            nodes = new TreeNode[capacity = 256];
+            tokens = new Token*[tokensCapacity = 256];
+            ends = new unsigned long[tokensCapacity];
+
+            length = numTokens = 0;
+
+            this->prev = prev;
+            numKept = numKeptTokens = 0;
+        }
+
+        /**
+         * @brief Releases the nodes and the tokens, the ones kept in place are still owned by the previous tree.
+         */
+        ~Tree ()
+        {
+            for (int i = 0; i < numTokens - numKeptTokens; i++)
+                delete tokens[i];
+
+            delete[] nodes;
+            delete[] tokens;
+            delete[] ends;
+        }
+
+        /**
+         * @brief Adds a leaf for a shifted token, the EOF token is released instead.
+         * @param token
+         * @param state
+         * @param end
+         */
+        void shift (Token *token, int state, unsigned long end)
+        {
+            if (token->getType() == -1)
+            {
+                delete token;
+                return;
+            }
+
+            TreeNode *node = push();
+
+            node->nonterm = -1;
+            node->rule = token->getType();
+            node->state = state;
+            node->count = 0;
+            node->size = 1;
+            node->first = numTokens;
+            node->last = numTokens + 1;
+
+            add (token, end);
+        }
+
+        /**
+         * @brief Adds a node for a reduction, its children are the last `count` subtrees.
+         * @param nonterm
+         * @param rule
+         * @param count
+         * @param state
+         */
+        void reduce (int nonterm, int rule, int count, int state)
+        {
+            int size = 1;
+
+            for (int i = 0; i < count; i++)
+                size += at(length - size)->size;
+
+            TreeNode *node = push();
+
+            node->nonterm = nonterm;
+            node->rule = rule;
+            node->state = state;
+            node->count = count;
+            node->size = size;
+            node->first = count ? at(length - size)->first : numTokens;
+            node->last = numTokens;
+        }
+
+        /**
+         * @brief Appends a copy of a subtree of another tree, taking over its tokens. The ends of the tokens are moved by `delta`.
+         * A subtree of the previous tree that follows the nodes kept in place is kept in place as well.
+         * @param tree
+         * @param index
+         * @param delta
+         */
+        void graft (Tree *tree, int index, long delta)
+        {
+            const TreeNode *root = &tree->nodes[index];
+            int start = index - root->size + 1, offset = numTokens - root->first;
+
+            if (tree == prev && length == numKept && start == numKept && root->first == numKeptTokens && delta == 0)
+            {
+                length = numKept = index + 1;
+                numTokens = numKeptTokens = root->last;
+                return;
+            }
+
+            for (int i = root->first; i < root->last; i++)
+            {
+                add (tree->tokens[i], tree->ends[i] + delta);
+                tree->tokens[i] = nullptr;
+            }
+
+            TreeNode *node = push (root->size);
+            memcpy (node, &tree->nodes[start], root->size * sizeof(TreeNode));
+
+            for (int i = 0; i < root->size; i++)
+            {
+                node[i].first += offset;
+                node[i].last += offset;
+            }
+        }
+
+        /**
+         * @brief Ends a reparse. The arrays of the previous tree are taken over, the nodes and tokens that follow the ones kept
+         * in place are moved after them, and the tokens of the previous tree that were not reused are released.
+         */
+        void merge ()
+        {
+            if (prev == nullptr)
+                return;
+
+            for (int i = numKeptTokens; i < prev->numTokens; i++)
+                delete prev->tokens[i];
+
+            if (length > prev->capacity)
+            {
+                TreeNode *temp = new TreeNode[prev->capacity = 2*length];
+                memcpy (temp, prev->nodes, numKept * sizeof(TreeNode));
+
+                delete[] prev->nodes;
+                prev->nodes = temp;
+            }
+
+            if (numTokens > prev->tokensCapacity)
+            {
+                Token **temp = new Token*[prev->tokensCapacity = 2*numTokens];
+                unsigned long *temp2 = new unsigned long[prev->tokensCapacity];
+
+                memcpy (temp, prev->tokens, numKeptTokens * sizeof(Token*));
+                memcpy (temp2, prev->ends, numKeptTokens * sizeof(unsigned long));
+
+                delete[] prev->tokens;
+                delete[] prev->ends;
+
+                prev->tokens = temp;
+                prev->ends = temp2;
+            }
+
+            memcpy (prev->nodes + numKept, nodes, (length - numKept) * sizeof(TreeNode));
+            memcpy (prev->tokens + numKeptTokens, tokens, (numTokens - numKeptTokens) * sizeof(Token*));
+            memcpy (prev->ends + numKeptTokens, ends, (numTokens - numKeptTokens) * sizeof(unsigned long));
+
+            delete[] nodes;
+            delete[] tokens;
+            delete[] ends;
+
+            nodes = prev->nodes;
+            capacity = prev->capacity;
+            tokens = prev->tokens;
+            ends = prev->ends;
+            tokensCapacity = prev->tokensCapacity;
+
+            prev->nodes = nullptr;
+            prev->tokens = nullptr;
+            prev->ends = nullptr;
+            prev->length = prev->numTokens = 0;
+
+            prev = nullptr;
+            numKept = numKeptTokens = 0;
+        }
+
+        /**
+         * @brief Removes a token from the tree and returns it, the caller takes over the token.
+         * @param i
+         * @return Token*
+         */
+        Token *releaseToken (int i)
+        {
+            Token *token = tokens[i];
+            tokens[i] = nullptr;
+
+            return token;
+        }
+
+        /**
+         * @brief Returns the number of nodes.
+         * @return int
+         */
+        int getLength() const {
+            return length;
+        }
+
+        /**
+         * @brief Returns the i-th node in postorder.
+         * @param i
+         * @return const TreeNode*
+         */
+        const TreeNode *getNode (int i) const {
+            return at(i);
+        }
+
+        /**
+         * @brief Returns the number of tokens.
+         * @return int
+         */
+        int getTokenCount() const {
+            return numTokens;
+        }
+
+        /**
+         * @brief Returns the i-th token.
+         * @param i
+         * @return Token*
+         */
+        Token *getToken (int i) const {
+            return tokens[i];
+        }
+
+        /**
+         * @brief Returns the offset in the source where the i-th token ends.
+         * @param i
+         * @return unsigned long
+         */
+        unsigned long getEnd (int i) const {
+            return ends[i];
+        }
+
+        /**
+         * @brief Returns a cursor on the root of the tree (the last node, not valid if the tree is empty).
+         * @return TreeCursor
+         */
+        TreeCursor getRoot() const {
+            return TreeCursor (this, length - 1, 0);
+        }
+    };
+
+    const TreeNode *TreeCursor::getNode() const {
+        return tree->getNode(index);
+    }
+
+    Token *TreeCursor::getToken() const {
+        return getNode()->first < getNode()->last ? tree->getToken(getNode()->first) : nullptr;
+    }
+
+#ifdef __parser_$0_incremental
+    /**
+     * @brief Input of an incremental parse after an edit of the source. The tokens around the edit are scanned again until
+     * they match the previous ones, and the remaining input is given by the subtrees of the previous tree. Items are kept on
+     * a stack with the next one on top: subtrees that cover changed tokens are broken down into their children, the others
+     * are reused whole by the parser when its state matches the state they were built in.
+     */
+    class TreeInput
+    {
+        protected:
+
+        /**
+         * @brief Previous tree, owned by the input.
+         */
+        Tree *tree;
+
+        /**
+         * @brief Tokens scanned again, and the offsets where they end.
+         */
+        Token **tokens;
+        unsigned long *ends;
+        int numTokens, tokensCapacity;
+
+        /**
+         * @brief Range of tokens of the previous tree replaced by the new tokens.
+         */
+        int first, last;
+
+        /**
+         * @brief Change in length of the source, applied to the offsets of the tokens after the edit.
+         */
+        long delta;
+
+        /**
+         * @brief Change in lines of the source and change in columns of the line where the edit ends (`line` in the previous
+         * source), applied to the positions of the tokens after the edit.
+         */
+        int lines, cols, line;
+
+        /**
+         * @brief Stack of items, a value `i` refers to the i-th node of the previous tree and `-1-i` to the i-th new token.
+         */
+        int *stack, sp, stackSize;
+
+        /**
+         * @brief EOF token, created when the input is exhausted.
+         */
+        Token *eof;
+
+        /**
+         * @brief Pushes an item to the stack.
+         * @param item
+         */
+        void push (int item)
+        {
+            if (sp == stackSize)
+            {
+                int *temp = new int[stackSize * 2];
+                memcpy (temp, stack, sp * sizeof(int));
+
+                delete[] stack;
+                stack = temp;
+                stackSize *= 2;
+            }
+
+            stack[sp++] = item;
+        }
+
+        /**
+         * @brief Moves the tokens of a node that follow the edit to their lines and columns in the new source.
+         * @param index
+         */
+        void reposition (int index)
+        {
+            const TreeNode *node = tree->getNode(index);
+
+            if (node->first < last || (lines == 0 && cols == 0))
+                return;
+
+            for (int i = node->first; i < node->last; i++)
+            {
+                Token *token = tree->getToken(i);
+                token->setPosition (token->getLine() + lines, token->getLine() == line ? token->getCol() + cols : token->getCol());
+            }
+        }
+
+        /**
+         * @brief Appends a new token.
+         * @param token
+         * @param end
+         */
+        void add (Token *token, unsigned long end)
+        {
+            if (numTokens == tokensCapacity)
+            {
+                Token **temp = new Token*[tokensCapacity * 2];
+                unsigned long *temp2 = new unsigned long[tokensCapacity * 2];
+
+                memcpy (temp, tokens, numTokens * sizeof(Token*));
+                memcpy (temp2, ends, numTokens * sizeof(unsigned long));
+
+                delete[] tokens;
+                delete[] ends;
+
+                tokens = temp;
+                ends = temp2;
+                tokensCapacity *= 2;
+            }
+
+            tokens[numTokens] = token;
+            ends[numTokens++] = end;
+        }
+
+        /**
+         * @brief Replaces the node on top of the stack with its children.
+         */
+        void breakdown ()
+        {
+            int item = stack[--sp];
+
+            for (int i = 0, child = item - 1; i < tree->getNode(item)->count; i++)
+            {
+                push (child);
+                child -= tree->getNode(child)->size;
+            }
+        }
+
+        /**
+         * @brief Breaks down the items on top of the stack until the top is a new token, or a node of the previous tree that
+         * does not cover changed tokens. Empty subtrees are dropped, the parser builds them again.
+         */
+        void normalize ()
+        {
+            while (sp > 0 && stack[sp-1] >= 0)
+            {
+                const TreeNode *node = tree->getNode(stack[sp-1]);
+
+                if (node->first == node->last)
+                {
+                    sp--;
+                    continue;
+                }
+
+                // The lookahead of a subtree (the token after it) must be unchanged as well.
+                if (first == last || node->first >= last || (node->nonterm != -1 ? node->last : node->first) < first)
+                    return;
+
+                if (node->nonterm != -1)
+                {
+                    breakdown ();
+                    continue;
+                }
+
+                // A changed token, the new tokens take the place of the first one.
+                sp--;
+
+                if (node->first == first)
+                {
+                    for (int i = numTokens - 1; i >= 0; i--)
+                        push (-1 - i);
+                }
+            }
+        }
+
+        public:
+
+        /**
+         * @brief Scans the source again around an edit. The edit replaced `removed` bytes at offset `start` of the previous source
+         * with `inserted` bytes, the data provider contains the whole new source.
+         *
+         * @param tree Previous tree, the input takes it over.
+         * @param input Data provider of the new source.
+         * @param start Offset of the edit.
+         * @param removed Number of bytes removed.
+         * @param inserted Number of bytes inserted.
+         */
+        TreeInput (Tree *tree, MemoryDataProvider *input, unsigned long start, unsigned long removed, unsigned long inserted)
+        {
+            int n = tree->getTokenCount(), linenum = 1, colnum = 1, i = 0;
+            unsigned long origin = 0;
+
+            this->tree = tree;
+            this->delta = (long)inserted - (long)removed;
+            this->lines = this->cols = this->line = 0;
+            this->eof = nullptr;
+
+            this->tokens = new Token*[this->tokensCapacity = 64];
+            this->ends = new unsigned long[this->tokensCapacity];
+            this->numTokens = 0;
+
+            this->stack = new int[this->stackSize = 256];
+            this->sp = 0;
+
+            // Restart one token before the edit, scanning the previous token may have looked past its end.
+            for (int j = n; i < j; )
+            {
+                int k = (i + j) / 2;
+
+                if (tree->getEnd(k) < start)
+                    i = k + 1;
+                else
+                    j = k;
+            }
+
+            if (i > 0) i--;
+
+            if (i > 0)
+            {
+                Token *token = tree->getToken(i-1);
+
+                origin = tree->getEnd(i-1);
+                linenum = token->getLine();
+                colnum = token->getCol();
+
+                for (const char *p = token->getValue(); p < token->getValue() + token->getLength(); p++)
+                {
+                    colnum++;
+
+                    if (*p == '\n')
+                    {
+                        colnum = 1;
+                        linenum++;
+                    }
+                }
+            }
+
+            first = i;
+            last = n;
+
+            input->seek (origin);
+
+            Scanner *scanner = new Scanner (input);
+            scanner->setOrigin (origin, linenum, colnum);
+
+            // Scanning stops when a token after the edit ends at the same place as a previous token with the same value.
+            for (int j = first; ; )
+            {
+                Token *token = scanner->shiftToken();
+                unsigned long end = scanner->getOffset();
+
+                if (token->getType() == -1)
+                {
+                    eof = token;
+                    break;
+                }
+
+                while (j < n && (long)tree->getEnd(j) + delta < (long)end) j++;
+
+                if (j < n && (long)tree->getEnd(j) + delta == (long)end && end - token->getLength() >= start + inserted && (j > first || numTokens == 0)
+                    && tree->getToken(j)->getType() == token->getType() && tree->getToken(j)->equals(token->getValue()))
+                {
+                    lines = token->getLine() - tree->getToken(j)->getLine();
+                    cols = token->getCol() - tree->getToken(j)->getCol();
+                    line = tree->getToken(j)->getLine();
+
+                    delete token;
+                    last = j;
+                    break;
+                }
+
+                add (token, end);
+            }
+
+            delete scanner;
+
+            if (first == n)
+            {
+                for (int k = numTokens - 1; k >= 0; k--)
+                    push (-1 - k);
+            }
+
+            if (tree->getLength() > 0)
+                push (tree->getLength() - 1);
+        }
+
+        /**
+         * @brief Releases the previous tree and the tokens that were not consumed.
+         */
+        ~TreeInput ()
+        {
+            for (int i = 0; i < numTokens; i++)
+                if (tokens[i] != nullptr) delete tokens[i];
+
+            if (eof != nullptr) delete eof;
+
+            delete tree;
+            delete[] tokens;
+            delete[] ends;
+            delete[] stack;
+        }
+
+        /**
+         * @brief Returns the previous tree.
+         * @return Tree*
+         */
+        Tree *getTree() const {
+            return tree;
+        }
+
+        /**
+         * @brief Returns the next token without consuming it.
+         * @return Token*
+         */
+        Token *peek ()
+        {
+            normalize ();
+
+            if (sp == 0)
+            {
+                if (eof == nullptr) eof = new Token ("", "", 0, -1, 0, 0);
+                return eof;
+            }
+
+            return stack[sp-1] < 0 ? tokens[-1 - stack[sp-1]] : tree->getToken(tree->getNode(stack[sp-1])->first);
+        }
+
+        /**
+         * @brief Returns the offset in the new source where the next token ends.
+         * @return unsigned long
+         */
+        unsigned long getEnd ()
+        {
+            normalize ();
+
+            if (sp == 0)
+                return 0;
+
+            if (stack[sp-1] < 0)
+                return ends[-1 - stack[sp-1]];
+
+            int i = tree->getNode(stack[sp-1])->first;
+            return tree->getEnd(i) + (i >= last ? delta : 0);
+        }
+
+        /**
+         * @brief Consumes the next token, the caller takes it over.
+         */
+        void consume ()
+        {
+            normalize ();
+
+            if (sp == 0)
+            {
+                eof = nullptr;
+                return;
+            }
+
+            while (stack[sp-1] >= 0 && tree->getNode(stack[sp-1])->nonterm != -1)
+            {
+                breakdown ();
+                normalize ();
+            }
+
+            int item = stack[--sp];
+
+            if (item < 0)
+                tokens[-1 - item] = nullptr;
+            else
+            {
+                reposition (item);
+                tree->releaseToken (tree->getNode(item)->first);
+            }
+        }
+
+        /**
+         * @brief Returns the index of the subtree on top of the stack and removes it if it was built in the given parser state,
+         * or -1 if it cannot be reused.
+         * @param state
+         * @return int
+         */
+        int reuse (int state)
+        {
+            normalize ();
+
+            if (sp == 0 || stack[sp-1] < 0)
+                return -1;
+
+            const TreeNode *node = tree->getNode(stack[sp-1]);
+
+            if (node->nonterm == -1 || node->state != state)
+                return -1;
+
+            reposition (stack[sp-1]);
+            return stack[--sp];
+        }
+
+        /**
+         * @brief Returns the change of the offsets of the tokens of a subtree.
+         * @param index
+         * @return long
+         */
+        long getDelta (int index) const {
+            return tree->getNode(index)->first >= last ? delta : 0;
+        }
+    };
+#endif
+
+#endif
     /**
      * @brief Source parser.
      */
@@ -28,6 +912,20 @@ namespace $0
          */
         void **argv;
 
+#ifdef __parser_$0_tree
+        /**
+         * @brief Syntax tree built by the last parse.
+         */
+        Tree *tree;
+#endif
+
+#ifdef __parser_$0_incremental
+        /**
+         * @brief Input of an incremental parse, `nullptr` when tokens are read from the scanner.
+         */
+        TreeInput *input;
+#endif
+
         public:
 
         /**
@@ -40,6 +938,12 @@ namespace $0
             this->stackSize = stackSize;
 
             this->argv = new void*[128];
+#ifdef __parser_$0_tree
+            this->tree = nullptr;
+#endif
+#ifdef __parser_$0_incremental
+            this->input = nullptr;
+#endif
         }
 
         /**
@@ -49,6 +953,9 @@ namespace $0
         {
             delete this->stack;
             delete this->argv;
+#ifdef __parser_$0_tree
+            if (this->tree != nullptr) delete this->tree;
+#endif
         }
 
         /**
@@ -63,13 +970,30 @@ namespace $0
             int nonterm, rule, release, shifted, bp=0;
 
             int *stack = this->stack, sp = 0;
-            void *temp, **argv = this->argv;
+            void **argv = this->argv;
+#ifndef __parser_$0_tree
+            void *temp;
+#endif
 
             Token *token = nullptr;
 
             if (context == nullptr)
                 context = new Context ();
 
+#ifdef __parser_$0_tree
+            unsigned long end = 0;
+
+            if (tree != nullptr) delete tree;
+#ifdef __parser_$0_incremental
+            tree = new Tree (input != nullptr ? input->getTree() : nullptr);
+#else
+            tree = new Tree ();
+#endif
+#else
+            // Tokens no action can observe are shifted by type only.
+            scanner->setObserved (tokenObserved, sizeof(tokenObserved));
+#endif
+
             while (1)
             {
                 if (error)
@@ -79,16 +1003,46 @@ namespace $0
                     for (int i = 1; i <= sp; i++)
                         printf (">> %u\n", stack[i]);
 
+#ifdef __parser_$0_tree
+                    delete tree;
+                    tree = nullptr;
+#endif
                     argv[0] = nullptr;
                     break;
                 }
 
                 if (shift)
                 {
+#ifdef __parser_$0_incremental
+                    if (token != nullptr && input != nullptr)
+                        input->consume ();
+#endif
+#ifdef __parser_$0_tree
+                    if (token != nullptr)
+                        tree->shift (token, stack[sp], end);
+#endif
+#ifdef __parser_$0_tree
                     if (token != nullptr)
                         argv[bp++] = token;
+#else
+                    if (token != nullptr)
+                        argv[bp++] = scanner->isShared(token) ? nullptr : token;
+#endif
 
-                    token = scanner->shiftToken();
+#ifdef __parser_$0_incremental
+                    if (input != nullptr)
+                    {
+                        token = input->peek();
+                        end = input->getEnd();
+                    }
+                    else
+#endif
+                    {
+                        token = scanner->shiftToken();
+#ifdef __parser_$0_tree
+                        end = scanner->getOffset();
+#endif
+                    }
                     symbol = token->getType();
                     shift = 0;
                 }
@@ -105,11 +1059,38 @@ namespace $0
                 {
                     if (sp == stackSize-1) { printf ("(Stack Overflow)\n"); error = 1; continue; }
                     stack[++sp] = state;
+
+#ifdef __parser_$0_incremental
+                    // A subtree of the previous tree built in this state is shifted whole, as the GOTO of an empty reduction.
+                    int index = input != nullptr ? input->reuse(state) : -1;
+
+                    if (index != -1)
+                    {
+                        tree->graft (input->getTree(), index, input->getDelta(index));
+
+                        nonterm = tree->getNode(tree->getLength() - 1)->nonterm;
+                        release = shifted = 0;
+                        reduce = 1;
+
+                        argv[bp] = nullptr;
+
+                        token = input->peek();
+                        end = input->getEnd();
+                        symbol = token->getType();
+                        continue;
+                    }
+#endif
                 }
 
                 $1
             }
 
+#ifdef __parser_$0_incremental
+            if (input != nullptr) token = nullptr;
+#endif
+#ifndef __parser_$0_tree
+            if (token != nullptr && scanner->isShared(token)) token = nullptr;
+#endif
             if (token != nullptr) delete token;
 
             return $R;
@@ -134,6 +1115,56 @@ namespace $0
             return value;
         }
 
+#ifdef __parser_$0_tree
+        /**
+         * @brief Parses data from the specified scanner and returns its syntax tree, or `nullptr` on error. The tree (and its
+         * tokens) must be released by the caller.
+         * @param scanner Scanner to obtain tokens.
+         * @param context Parser context.
+         * @return Tree*
+         */
+        Tree *parseTree (Scanner *scanner, Context *context=nullptr)
+        {
+            parse (scanner, context);
+
+            Tree *tree = this->tree;
+            this->tree = nullptr;
+
+            return tree;
+        }
+
+#ifdef __parser_$0_incremental
+        /**
+         * @brief Parses a source again after an edit and returns its new syntax tree, or `nullptr` on error. The edit replaced
+         * `removed` bytes at offset `start` of the source of the given tree with `inserted` bytes. Only the tokens around the
+         * edit are scanned again, and subtrees that do not cover changed tokens are reused when the parser reaches them in the
+         * same state they were built in. The previous tree is released (and its tokens taken over by the new one).
+         *
+         * @param tree Tree of the previous source.
+         * @param input Data provider of the whole new source.
+         * @param start Offset of the edit.
+         * @param removed Number of bytes removed.
+         * @param inserted Number of bytes inserted.
+         * @param context Parser context.
+         * @return Tree*
+         */
+        Tree *reparse (Tree *tree, MemoryDataProvider *input, unsigned long start, unsigned long removed, unsigned long inserted, Context *context=nullptr)
+        {
+            this->input = new TreeInput (tree, input, start, removed, inserted);
+
+            Tree *value = parseTree (nullptr, context);
+
+            if (value != nullptr)
+                value->merge ();
+
+            delete this->input;
+            this->input = nullptr;
+
+            return value;
+        }
+#endif
+
+#endif
         /**
          * @brief Parses data from the specified file and returns the parser structure. A new parser and scanner will be automatically
          * created and released when using this method.
@@ -0,0 +1,161 @@
+/*
+**	This file was generated by the RedStar Pegasus tool.
+*/
+
+#ifndef __parser_$0_h
+#define __parser_$0_h
+
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace $0
+{
+$3
+    /**
+     * @brief Source parser (recursive ascent). Every state is a member function that receives the values of the symbols on top
+     * of the stack as typed arguments, shifts by calling the function of the next state and returns the number of frames that
+     * must still be unwound after a reduction. The frame where the count reaches zero performs the GOTO of the reduced rule.
+     */
+    class Parser
+    {
+        protected:
+
+        /**
+         * @brief Maximum nesting of state functions and current nesting.
+         */
+        int stackSize, depth;
+
+        /**
+         * @brief Error flag, type of the lookahead token and non-terminal of the last reduction.
+         */
+        int error, symbol, nonterm;
+
+        /**
+         * @brief Scanner to obtain tokens and current lookahead token.
+         */
+        Scanner *scanner;
+        Token *token;
+
+        /**
+         * @brief Parser context.
+         */
+        Context *context;
+
+        /**
+         * @brief Value of the last reduced non-terminal.
+         */
+        void *value;
+
+        /**
+         * @brief Returns the lookahead token and reads the next one from the scanner. Tokens of types no action can observe
+         * are returned as `nullptr`.
+         * @return Token*
+         */
+        Token *shift ()
+        {
+            Token *temp = this->token;
+
+            this->token = this->scanner->shiftToken();
+            this->symbol = this->token->getType();
+
+            return this->scanner->isShared(temp) ? nullptr : temp;
+        }
+
+$1
+
+        public:
+
+        /**
+         * @brief Initializes the parser context.
+         * @param stackSize Maximum nesting of states (default: 1024).
+         */
+        Parser (int stackSize=1024)
+        {
+            this->stackSize = stackSize;
+            this->token = nullptr;
+        }
+
+        /**
+         * @brief Releases resources.
+         */
+        ~Parser()
+        {
+        }
+
+        /**
+         * @brief Parses data from the specified scanner and returns the parsed structure.
+         * @param scanner Scanner to obtain tokens.
+         * @param context Parser context.
+         * @return $T
+         */
+        $T parse (Scanner *scanner, Context *context=nullptr)
+        {
+            if (context == nullptr)
+                context = new Context ();
+
+            this->scanner = scanner;
+            this->context = context;
+
+            this->error = 0;
+            this->depth = 0;
+            this->value = nullptr;
+
+            scanner->setObserved (tokenObserved, sizeof(tokenObserved));
+
+            this->token = scanner->shiftToken();
+            this->symbol = this->token->getType();
+
+            state1 ();
+
+            if (error)
+            {
+                printf ("(Parser Error)\n");
+                value = nullptr;
+            }
+
+            if (token != nullptr && !scanner->isShared(token)) delete token;
+            token = nullptr;
+
+            return $R;
+        };
+
+        /**
+         * @brief Parses data from the specified file and returns the parsed structure. An scanner will be automatically created.
+         * @param filepath Path to the source file.
+         * @param context Parser context.
+         * @return $T
+         */
+        $T parse (const char *filepath, Context *context=nullptr)
+        {
+            IDataProvider *input = new FileDataProvider (filepath);
+            Scanner *scanner = new Scanner (input);
+
+            $T value = parse (scanner, context);
+
+            delete scanner;
+            delete input;
+
+            return value;
+        }
+
+        /**
+         * @brief Parses data from the specified file and returns the parser structure. A new parser and scanner will be automatically
+         * created and released when using this method.
+         *
+         * @param filepath Path to the source file.
+         * @param context Parser context.
+         * @return $T
+         */
+        static $T parseFile (const char *filepath, Context *context=nullptr)
+        {
+            Parser *parser = new Parser ();
+
+            $T value = parser->parse (filepath, context);
+            delete parser;
+
+            return value;
+        }
+    };
+};
+
+#endif
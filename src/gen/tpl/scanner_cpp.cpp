@@ -4,6 +4,7 @@
 
 #ifndef __scanner_$0_h
 #define __scanner_$0_h
+$D
 
 #include <asr/utils/List>
 #include <asr/utils/Linkable>
@@ -11,6 +12,20 @@
 #include <stdio.h>
 #include <string.h>
 
+#if (defined(__scanner_$0_lazy_positions) || defined(__scanner_$0_parallel)) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__scanner_$0_spans) && defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__scanner_$0_spans) && defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#ifdef __scanner_$0_parallel
+#include <thread>
+#endif
+
 namespace $0
 {
     using asr::utils::List;
@@ -23,6 +38,11 @@ namespace $0
     {
         public:
 
+        /**
+         * @brief Releases the data provider, providers are deleted through this interface.
+         */
+        virtual ~IDataProvider() {}
+
         /**
          * @brief Returns the name of the data provider.
          * @return const char* 
@@ -34,6 +54,25 @@ namespace $0
          * @return int 
          */
         virtual int getByte (void) = 0;
+
+        /**
+         * @brief Reads up to `length` bytes into the buffer and returns the number of bytes read, zero on EOF. The default
+         * implementation returns a single byte from `getByte`, so interactive sources are never waited on for more input
+         * than the scanner needs, providers with block access should override it to fill the buffer at once.
+         * @param buffer 
+         * @param length 
+         * @return int 
+         */
+        virtual int read (char *buffer, int length)
+        {
+            int ch = length > 0 ? getByte() : -1;
+
+            if (ch == -1)
+                return 0;
+
+            buffer[0] = ch;
+            return 1;
+        }
     };
 
     /**
@@ -94,7 +133,237 @@ namespace $0
         {
             return this->fp == nullptr ? -1 : getc (this->fp);
         }
+
+        /**
+         * @brief Reads up to `length` bytes into the buffer and returns the number of bytes read, zero on EOF.
+         * @param buffer 
+         * @param length 
+         * @return int 
+         */
+        virtual int read (char *buffer, int length)
+        {
+            return this->fp == nullptr ? 0 : (int)fread (buffer, 1, length, this->fp);
+        }
+    };
+
+    /**
+     * @brief Memory data provider, reads data from a buffer owned by the caller.
+     */
+    class MemoryDataProvider : public IDataProvider
+    {
+        protected:
+
+        /**
+         * @brief Name of the data source.
+         */
+        const char *name;
+
+        /**
+         * @brief Source data.
+         */
+        const char *data;
+
+        /**
+         * @brief Length of the data and current read position.
+         */
+        unsigned long length, position;
+
+        public:
+
+        /**
+         * @brief Initializes the data provider to read data from the specified buffer.
+         * @param name 
+         * @param data 
+         * @param length 
+         */
+        MemoryDataProvider (const char *name, const char *data, unsigned long length)
+        {
+            this->name = name;
+            this->data = data;
+            this->length = length;
+            this->position = 0;
+        }
+
+        /**
+         * @brief Returns the name of the data provider.
+         * @return const char* 
+         */
+        virtual const char *getName (void)
+        {
+            return this->name;
+        }
+
+        /**
+         * @brief Reads a byte from the data source and returns it. A -1 will be returned on EOF.
+         * @return int 
+         */
+        virtual int getByte (void)
+        {
+            return this->position < this->length ? (unsigned char)this->data[this->position++] : -1;
+        }
+
+        /**
+         * @brief Reads up to `length` bytes into the buffer and returns the number of bytes read, zero on EOF.
+         * @param buffer 
+         * @param length 
+         * @return int 
+         */
+        virtual int read (char *buffer, int length)
+        {
+            if ((unsigned long)length > this->length - this->position)
+                length = this->length - this->position;
+
+            memcpy (buffer, this->data + this->position, length);
+            this->position += length;
+
+            return length;
+        }
+
+        /**
+         * @brief Returns the source data.
+         * @return const char* 
+         */
+        const char *getData() const {
+            return this->data;
+        }
+
+        /**
+         * @brief Returns the length of the source data.
+         * @return unsigned long 
+         */
+        unsigned long getLength() const {
+            return this->length;
+        }
+
+        /**
+         * @brief Moves the read position to the given offset.
+         * @param position 
+         */
+        void seek (unsigned long position)
+        {
+            this->position = position < this->length ? position : this->length;
+        }
+    };
+
+#ifdef __scanner_$0_lazy_positions
+    /**
+     * @brief Sorted list of the byte offsets where each line of the input starts. Built by the scanner every time its input
+     * buffer is refilled, and used by tokens to compute line and column numbers only when requested.
+     */
+    class LineIndex
+    {
+        protected:
+
+        /**
+         * @brief Offsets of the first byte of every line, the first entry is always zero.
+         */
+        unsigned long *starts;
+
+        /**
+         * @brief Number of entries and allocated capacity.
+         */
+        int count, capacity;
+
+        /**
+         * @brief Appends the offset of a line start.
+         * @param offset 
+         */
+        void add (unsigned long offset)
+        {
+            if (count == capacity)
+            {
+                unsigned long *temp = new unsigned long[capacity *= 2];
+                memcpy (temp, starts, count*sizeof(unsigned long));
+
+                delete[] starts;
+                starts = temp;
+            }
+
+            starts[count++] = offset;
+        }
+
+        public:
+
+        /**
+         * @brief Initializes an index with a single line starting at offset zero.
+         */
+        LineIndex ()
+        {
+            starts = new unsigned long[capacity = 256];
+            starts[0] = 0;
+            count = 1;
+        }
+
+        /**
+         * @brief Releases the index.
+         */
+        ~LineIndex ()
+        {
+            delete[] starts;
+        }
+
+        /**
+         * @brief Adds the line starts found in a block of input data located at the given offset. Blocks must be provided in order.
+         * @param data 
+         * @param length 
+         * @param offset 
+         */
+        void scan (const char *data, int length, unsigned long offset)
+        {
+            int i = 0;
+
+#ifdef __SSE2__
+            const __m128i nl = _mm_set1_epi8('\n');
+
+            for (; i + 16 <= length; i += 16)
+            {
+                unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(data + i)), nl));
+
+                for (; mask != 0; mask &= mask - 1)
+                    add (offset + i + __builtin_ctz(mask) + 1);
+            }
+#endif
+
+            for (; i < length; i++)
+            {
+                if (data[i] == '\n')
+                    add (offset + i + 1);
+            }
+        }
+
+        /**
+         * @brief Returns the line number (starting at 1) of the byte at the given offset.
+         * @param offset 
+         * @return unsigned 
+         */
+        unsigned getLine (unsigned long offset) const
+        {
+            int lo = 1, hi = count;
+
+            while (lo < hi)
+            {
+                int mid = (lo + hi) >> 1;
+
+                if (starts[mid] <= offset)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+
+            return lo;
+        }
+
+        /**
+         * @brief Returns the column number (starting at 1) of the byte at the given offset.
+         * @param offset 
+         * @return unsigned 
+         */
+        unsigned getCol (unsigned long offset) const
+        {
+            return offset - starts[getLine(offset) - 1] + 1;
+        }
     };
+#endif
 
     /**
      * @brief Describes a token, that is a string obtained from a data source that belongs to a certain token group which gives it meaning.
@@ -125,6 +394,17 @@ $2
          */
         const char *source;
 
+#ifdef __scanner_$0_lazy_positions
+        /**
+         * @brief Byte offset of the token in the source.
+         */
+        unsigned long offset;
+
+        /**
+         * @brief Line index of the source, owned by the scanner.
+         */
+        LineIndex *lines;
+#else
         /**
          * @brief Line number.
          */
@@ -134,9 +414,23 @@ $2
          * @brief Column number.
          */
         unsigned col;
+#endif
 
         public:
 
+#ifdef __scanner_$0_lazy_positions
+        /**
+         * @brief Initializes the token object with the specified parameters.
+         * 
+         * @param source Data source name.
+         * @param value Token value.
+         * @param length Length.
+         * @param type Token type.
+         * @param offset Byte offset.
+         * @param lines Line index used to compute the line and column numbers, must outlive the token.
+         */
+        Token (const char *source, const char *value, int length, int type, unsigned long offset, LineIndex *lines)
+#else
         /**
          * @brief Initializes the token object with the specified parameters.
          * 
@@ -148,14 +442,20 @@ $2
          * @param col Column number.
          */
         Token (const char *source, const char *value, int length, int type, int line, int col)
+#endif
         {
             this->value = (char *)new char[length+1];
             this->length = length;
             this->type = type;
 
             this->source = source;
+#ifdef __scanner_$0_lazy_positions
+            this->offset = offset;
+            this->lines = lines;
+#else
             this->line = line;
             this->col = col;
+#endif
 
             memcpy (this->value, value, length);
             this->value[length] = '\0';
@@ -181,6 +481,21 @@ $2
             return this;
         }
 
+#ifndef __scanner_$0_lazy_positions
+        /**
+         * @brief Changes the line and column numbers of the token.
+         * @param line 
+         * @param col 
+         * @return Token* 
+         */
+        Token *setPosition (int line, int col)
+        {
+            this->line = line;
+            this->col = col;
+            return this;
+        }
+#endif
+
         /**
          * @brief Compares two tokens and returns true if both are equal.
          * @param token 
@@ -293,7 +608,11 @@ $2
          * @return int 
          */
         int getCol() const {
+#ifdef __scanner_$0_lazy_positions
+            return this->lines != nullptr ? this->lines->getCol(this->offset) : 0;
+#else
             return this->col;
+#endif
         }
 
         /**
@@ -301,16 +620,86 @@ $2
          * @return int 
          */
         int getLine() const {
+#ifdef __scanner_$0_lazy_positions
+            return this->lines != nullptr ? this->lines->getLine(this->offset) : 0;
+#else
             return this->line;
+#endif
         }
+#ifdef __scanner_$0_lazy_positions
+
+        /**
+         * @brief Returns the byte offset where the token appears in the source.
+         * @return unsigned long 
+         */
+        unsigned long getOffset() const {
+            return this->offset;
+        }
+#endif
     };
 
 
+$3
+#ifdef __scanner_$0_spans
+    /**
+     * @brief Returns the number of bytes at the start of the range [p, e) that belong to the byte set of the given span kernel,
+     * that is, the bytes on which a DFA state loops back to itself. Bytes are classified 32 (AVX2) and then 16 (SSSE3) at a time
+     * by looking up their low and high nibbles with a byte shuffle, the tail is classified one byte at a time with the same tables.
+     * @param k 
+     * @param p 
+     * @param e 
+     * @return int 
+     */
+    static inline int spanLength (int k, const char *p, const char *e)
+    {
+        const char *s = p;
+
+#ifdef __AVX2__
+        const __m256i lo = _mm256_broadcastsi128_si256 (_mm_load_si128 ((const __m128i *)dfaSpanLo[k]));
+        const __m256i hi = _mm256_broadcastsi128_si256 (_mm_load_si128 ((const __m128i *)dfaSpanHi[k]));
+        const __m256i mask = _mm256_set1_epi8 (0x0F);
+
+        for (; e - p >= 32; p += 32)
+        {
+            __m256i v = _mm256_loadu_si256 ((const __m256i *)p);
+            __m256i m = _mm256_and_si256 (_mm256_shuffle_epi8 (lo, _mm256_and_si256 (v, mask)),
+                _mm256_shuffle_epi8 (hi, _mm256_and_si256 (_mm256_srli_epi16 (v, 4), mask)));
+
+            unsigned int miss = _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (m, _mm256_setzero_si256()));
+            if (miss) return (p - s) + __builtin_ctz(miss);
+        }
+#endif
+
+#ifdef __SSSE3__
+        const __m128i lo16 = _mm_load_si128 ((const __m128i *)dfaSpanLo[k]);
+        const __m128i hi16 = _mm_load_si128 ((const __m128i *)dfaSpanHi[k]);
+        const __m128i mask16 = _mm_set1_epi8 (0x0F);
+
+        for (; e - p >= 16; p += 16)
+        {
+            __m128i v = _mm_loadu_si128 ((const __m128i *)p);
+            __m128i m = _mm_and_si128 (_mm_shuffle_epi8 (lo16, _mm_and_si128 (v, mask16)),
+                _mm_shuffle_epi8 (hi16, _mm_and_si128 (_mm_srli_epi16 (v, 4), mask16)));
+
+            unsigned int miss = _mm_movemask_epi8 (_mm_cmpeq_epi8 (m, _mm_setzero_si128()));
+            if (miss) return (p - s) + __builtin_ctz(miss);
+        }
+#endif
+
+        for (; p < e && (dfaSpanLo[k][*p & 15] & dfaSpanHi[k][(unsigned char)*p >> 4]); p++);
+        return p - s;
+    }
+
+#endif
     /**
      * @brief Source scanner.
      */
     class Scanner
     {
+#ifdef __scanner_$0_parallel
+        friend class ParallelScanner;
+#endif
+
         protected:
 
         /**
@@ -335,12 +724,239 @@ $2
         int *stack, sp, stackSize;
 
         /**
-         * @brief Buffer for the last token parsed.
+         * @brief Buffer for the last token parsed and its size.
          */
         char *value;
+        int valueSize;
+
+        /**
+         * @brief Size of the input buffer.
+         */
+        static const int BUFFER_SIZE = 65536;
+
+        /**
+         * @brief Input buffer, read pointer and end of the valid data in the buffer.
+         */
+        char *buffer, *ip, *ie;
+
+        /**
+         * @brief Offset in the source of the first byte of the input buffer.
+         */
+        unsigned long base;
+
+        /**
+         * @brief Offset in the source of the next token.
+         */
+        unsigned long offset;
+
+        /**
+         * @brief When set, errors are not reported on the standard output.
+         */
+        bool quiet;
+
+        /**
+         * @brief Token types whose tokens are observed by the consumer, indexed from the first exported type (256). Tokens of
+         * other types are not created, a single shared token with no value stands for all of them.
+         */
+        const unsigned char *observed;
+        int numObserved;
+
+        /**
+         * @brief Shared tokens of the types that are not observed, owned by the scanner.
+         */
+        Token **shared;
+
+#ifdef __scanner_$0_lazy_positions
+        /**
+         * @brief Line index of the source.
+         */
+        LineIndex *lines;
+
+        /**
+         * @brief Indicates if the line index is owned (and built) by this scanner.
+         */
+        bool ownsLines;
+#endif
+
+        /**
+         * @brief Refills the input buffer and returns the next byte from it, or -1 on EOF.
+         * @return int 
+         */
+        int fill ()
+        {
+            base += ie - buffer;
+
+            int n = input->read (buffer, BUFFER_SIZE);
+            if (n <= 0) n = 0;
+
+            ip = buffer;
+            ie = buffer + n;
+
+            if (n == 0)
+                return -1;
+
+#ifdef __scanner_$0_lazy_positions
+            if (ownsLines)
+                lines->scan (buffer, n, base);
+#endif
+
+            return (unsigned char)*ip++;
+        }
+
+        /**
+         * @brief Doubles the size of the token buffer and returns the buffer pointer `bp` relocated to the new buffer.
+         * @param bp 
+         * @return char* 
+         */
+        char *grow (char *bp)
+        {
+            char *temp = new char[valueSize * 2];
+            memcpy (temp, value, valueSize);
+
+            bp = temp + (bp - value);
+            valueSize *= 2;
+
+            delete[] value;
+            value = temp;
+
+            return bp;
+        }
+
+        /**
+         * @brief Returns the token for the value in the token buffer, or the shared token of its type when it is not observed.
+         * @param length 
+         * @param type 
+         * @param offset Offset of the token, with lazy positions.
+         * @param linenum Line of the token, without lazy positions.
+         * @param colnum Column of the token, without lazy positions.
+         * @return Token* 
+         */
+#ifdef __scanner_$0_lazy_positions
+        Token *createToken (int length, int type, unsigned long offset)
+#else
+        Token *createToken (int length, int type, int linenum, int colnum)
+#endif
+        {
+            type = translate (this->value, length, type);
+
+            if (observed != nullptr && type >= 256 && type - 256 < numObserved && !observed[type - 256])
+            {
+                if (shared[type - 256] == nullptr)
+#ifdef __scanner_$0_lazy_positions
+                    shared[type - 256] = new Token (input->getName(), "", 0, type, 0, nullptr);
+#else
+                    shared[type - 256] = new Token (input->getName(), "", 0, type, 0, 0);
+#endif
+
+                return shared[type - 256];
+            }
+
+#ifdef __scanner_$0_lazy_positions
+            return new Token (input->getName(), this->value, length, type, offset, lines);
+#else
+            return new Token (input->getName(), this->value, length, type, linenum, colnum);
+#endif
+        }
+
+#ifdef __scanner_$0_dfa
+        /**
+         * @brief Returns the last `length` bytes read back to the input, they are given in `data`.
+         * @param data 
+         * @param length 
+         */
+        void unread (const char *data, int length)
+        {
+            if (ip - buffer >= length)
+            {
+                ip -= length;
+                return;
+            }
+
+            int rest = ie - ip;
+            char *temp = new char[length + rest > BUFFER_SIZE ? length + rest : BUFFER_SIZE];
+
+            memcpy (temp, data, length);
+            memcpy (temp + length, ip, rest);
+
+            base += (ip - buffer) - length;
+
+            delete[] buffer;
+            buffer = ip = temp;
+            ie = temp + length + rest;
+        }
+#endif
 
         public:
 
+        /**
+         * @brief Makes the scanner behave as if its input was located at the given offset, line and column of a larger source.
+         * Used to scan a fragment of a source, must be called before the first token is scanned.
+         * @param offset 
+         * @param linenum 
+         * @param colnum 
+         */
+        void setOrigin (unsigned long offset, int linenum, int colnum=1)
+        {
+            this->offset = this->base = offset;
+            this->linenum = linenum;
+            this->colnum = colnum;
+        }
+
+        /**
+         * @brief Returns the offset in the source where the last scanned token ends, scanning resumes from this offset.
+         * @return unsigned long 
+         */
+        unsigned long getOffset() const {
+            return this->offset;
+        }
+
+        /**
+         * @brief Sets the token types observed by the consumer of the tokens, the flags are indexed from the first exported
+         * type (256). Tokens of the other types are then returned as a shared token of their type with no value or position,
+         * which must not be deleted (see `isShared`). The flags are not copied, a `nullptr` makes all the tokens observed.
+         * @param observed 
+         * @param count 
+         */
+        void setObserved (const unsigned char *observed, int count)
+        {
+            if (observed == this->observed && count == this->numObserved)
+                return;
+
+            // Shared tokens still queued are replaced by tokens of their own before the shared ones are released.
+            for (Linkable<Token*> *i = this->queue->head(); i; i = i->next())
+            {
+                if (isShared(i->value))
+#ifdef __scanner_$0_lazy_positions
+                    i->value = new Token (input->getName(), "", 0, i->value->getType(), 0, nullptr);
+#else
+                    i->value = new Token (input->getName(), "", 0, i->value->getType(), 0, 0);
+#endif
+            }
+
+            for (int i = 0; i < numObserved; i++)
+                if (shared[i] != nullptr) delete shared[i];
+
+            delete[] shared;
+
+            this->observed = observed;
+            this->numObserved = observed != nullptr ? count : 0;
+            this->shared = new Token*[this->numObserved];
+
+            for (int i = 0; i < numObserved; i++)
+                shared[i] = nullptr;
+        }
+
+        /**
+         * @brief Indicates if a token is the shared token of a type that is not observed, and so it is owned by the scanner.
+         * @param token 
+         * @return bool 
+         */
+        bool isShared (Token *token) const
+        {
+            int i = token->getType() - 256;
+            return i >= 0 && i < numObserved && shared[i] == token;
+        }
+
         /**
          * @brief Initializes the scanner context.
          * @param input Data provider.
@@ -361,7 +977,21 @@ $2
             this->stackSize = stackSize;
             this->sp = 0;
 
-            *(this->value = new char[1024]) = '\0';
+            this->buffer = this->ip = this->ie = new char[BUFFER_SIZE];
+            this->base = 0;
+            this->offset = 0;
+            this->quiet = false;
+
+            this->observed = nullptr;
+            this->numObserved = 0;
+            this->shared = new Token*[0];
+
+#ifdef __scanner_$0_lazy_positions
+            this->lines = new LineIndex ();
+            this->ownsLines = true;
+#endif
+
+            *(this->value = new char[this->valueSize = 1024]) = '\0';
             this->queue = new List<Token*> ();
         }
 
@@ -370,9 +1000,24 @@ $2
          */
         ~Scanner ()
         {
+            // Shared tokens may still be queued, they are released below.
+            for (Linkable<Token*> *i = this->queue->head(); i; i = i->next())
+                if (isShared(i->value)) i->value = nullptr;
+
             delete this->queue->clear();
             delete this->stack;
-            delete this->value;
+            delete[] this->value;
+            delete[] this->buffer;
+
+            for (int i = 0; i < numObserved; i++)
+                if (shared[i] != nullptr) delete shared[i];
+
+            delete[] this->shared;
+
+#ifdef __scanner_$0_lazy_positions
+            if (this->ownsLines)
+                delete this->lines;
+#endif
         }
 
         /**
@@ -419,9 +1064,13 @@ $2
         protected:
 
         /**
-         * @brief Translates a token to an array-token if the token code matches the array composition code.
+         * @brief Returns the type of an array-token if the token value and code match an array, the given type otherwise.
+         * @param value 
+         * @param length 
+         * @param type 
+         * @return int 
          */
-        Token *translate (Token *token)
+        int translate (const char *value, int length, int type)
         {
 $E
         }
@@ -436,16 +1085,121 @@ $E
         {
             int error=0, reduce=0, state=this->state, shift=this->shift;
             int nonterm, release, code, symbol=this->symbol;
+            unsigned long _offset=this->offset;
+#ifndef __scanner_$0_lazy_positions
             int _colnum=this->colnum, _linenum=this->linenum;
+#endif
 
             int *stack = this->stack, sp = this->sp;
             char *bp = this->value;
 
+#ifdef __scanner_$0_dfa
+            // Regular tokens are scanned with the DFA using the longest match, the state machine below only scans tokens that
+            // start with a byte the DFA does not handle, and the EOF.
+            if (shift && symbol == -1)
+            {
+                symbol = ip != ie ? (unsigned char)*ip++ : fill();
+                shift = 0;
+            }
+
+            while (symbol != -1 && (state = dfaStart[symbol]) != 0)
+            {
+                int accept = 0, length = 0;
+
+                while (1)
+                {
+                    if (bp == this->value + valueSize - 1) bp = grow(bp);
+                    *bp++ = symbol;
+
+#ifdef __scanner_$0_spans
+                    // The state loops on a set of bytes, consume the whole run at once.
+                    if (dfaSpan[state])
+                    {
+                        int n = spanLength (dfaSpan[state] - 1, ip, ie);
+
+                        while (bp + n >= this->value + valueSize - 1) bp = grow(bp);
+
+                        memcpy (bp, ip, n);
+                        bp += n;
+                        ip += n;
+                    }
+
+#endif
+                    if (dfaAccept[state]) {
+                        accept = dfaAccept[state];
+                        length = bp - this->value;
+                    }
+
+                    symbol = ip != ie ? (unsigned char)*ip++ : fill();
+
+                    if (symbol == -1 || (state = dfaNext[state][dfaClass[symbol]]) == 0)
+                        break;
+                }
+
+                state = this->state;
+
+                if (accept == 0)
+                {
+                    error = 1;
+                    break;
+                }
+
+                if (bp - this->value > length)
+                {
+                    if (symbol != -1) *bp++ = symbol;
+
+                    unread (this->value + length, (bp - this->value) - length);
+                    bp = this->value + length;
+
+                    symbol = ip != ie ? (unsigned char)*ip++ : fill();
+                }
+
+#ifndef __scanner_$0_lazy_positions
+                for (char *p = this->value; p < bp; p++)
+                {
+                    colnum++;
+
+                    if (*p == '\n')
+                    {
+                        colnum = 1;
+                        linenum++;
+                    }
+                }
+#endif
+
+                if (accept == 1)
+                {
+                    _offset += bp - this->value;
+#ifndef __scanner_$0_lazy_positions
+                    _linenum = linenum;
+                    _colnum = colnum;
+#endif
+                    bp = this->value;
+                    continue;
+                }
+
+                *bp = '\0';
+
+                this->offset = _offset + (bp - this->value);
+                this->symbol = symbol;
+                this->shift = 0;
+
+#ifdef __scanner_$0_lazy_positions
+                this->queue->push (createToken ((int)(bp - this->value), accept, _offset));
+#else
+                this->queue->push (createToken ((int)(bp - this->value), accept, _linenum, _colnum));
+#endif
+                return true;
+            }
+
+            state = this->state;
+#endif
+
             while (1)
             {
                 if (error)
                 {
-                    printf ("error");
+                    if (!quiet) printf ("error");
                     break;
                 }
 
@@ -453,8 +1207,9 @@ $E
                 {
                     if (symbol != -1)
                     {
+                        if (bp == this->value + valueSize - 1) bp = grow(bp);
                         *bp++ = symbol;
-
+#ifndef __scanner_$0_lazy_positions
                         colnum++;
 
                         if (symbol == '\n')
@@ -462,9 +1217,10 @@ $E
                             colnum = 1;
                             linenum++;
                         }
+#endif
                     }
 
-                    symbol = input->getByte();
+                    symbol = ip != ie ? (unsigned char)*ip++ : fill();
                     shift = 0;
                 }
 
@@ -477,7 +1233,8 @@ $E
 
                     if (reduce == 2)
                     {
-                        this->sp = sp;
+                        // The state is pushed again when scanning resumes.
+                        this->sp = sp - 1;
                         this->state = state;
                         this->shift = shift;
                         this->symbol = symbol;
@@ -487,31 +1244,331 @@ $E
 
                     if (reduce == 3)
                     {
+                        _offset += bp - this->value;
+#ifndef __scanner_$0_lazy_positions
                         _linenum = linenum;
                         _colnum = colnum;
+#endif
 
                         bp = this->value;
                     }
 
                     if (reduce == 2)
                     {
-                        this->queue->push (translate (new Token (input->getName(), this->value, (int)(bp - this->value), code, _linenum, _colnum)));
+                        this->offset = _offset + (bp - this->value);
+#ifdef __scanner_$0_lazy_positions
+                        this->queue->push (createToken ((int)(bp - this->value), code, _offset));
+#else
+                        this->queue->push (createToken ((int)(bp - this->value), code, _linenum, _colnum));
+#endif
                         return true;
                     }
                 }
                 else
                 {
-                    if (sp == stackSize-1) { printf ("stack overflow"); error = 1; continue; }
+                    if (sp == stackSize-1) { if (!quiet) printf ("stack overflow"); error = 1; continue; }
                     stack[++sp] = state;
                 }
 
 $1
             }
 
+            this->offset = _offset;
+
+#ifdef __scanner_$0_lazy_positions
+            this->queue->push (new Token (input->getName(), "", 0, -1, _offset, lines));
+#else
             this->queue->push (new Token (input->getName(), "", 0, -1, _linenum, _colnum));
+#endif
             return false;
         }
     };
+
+#ifdef __scanner_$0_parallel
+    /**
+     * @brief Scanner for in-memory sources that lexes chunks of the source speculatively on several threads. Every chunk starts
+     * right after a newline in the initial scanner state, chunk seams are then verified (and re-scanned where the speculation was
+     * wrong) sequentially, so the resulting token stream is identical to the one of a single scanner. All tokens are scanned on
+     * construction.
+     */
+    class ParallelScanner : public Scanner
+    {
+        protected:
+
+        /**
+         * @brief Minimum size of a chunk.
+         */
+        static const unsigned long MIN_CHUNK_SIZE = 1 << 18;
+
+        /**
+         * @brief Source fragment scanned by a worker and the tokens obtained from it.
+         */
+        struct Chunk
+        {
+            /**
+             * @brief Scanner and data provider of the fragment.
+             */
+            Scanner *scanner;
+            MemoryDataProvider *input;
+
+            /**
+             * @brief Offsets of the first byte of the chunk and of the next chunk.
+             */
+            unsigned long start, end;
+
+            /**
+             * @brief Number of newlines in the chunk.
+             */
+            unsigned long lines;
+
+            /**
+             * @brief Scanned tokens and their offsets in the source.
+             */
+            Token **tokens;
+            unsigned long *offsets;
+
+            /**
+             * @brief Index of the first accepted token, number of tokens and capacity of the arrays.
+             */
+            int first, count, capacity;
+        };
+
+        /**
+         * @brief Returns the number of newlines in a block of data.
+         * @param data 
+         * @param length 
+         * @return unsigned long 
+         */
+        static unsigned long countLines (const char *data, unsigned long length)
+        {
+            unsigned long i = 0, n = 0;
+
+#ifdef __SSE2__
+            const __m128i nl = _mm_set1_epi8('\n');
+
+            for (; i + 16 <= length; i += 16)
+                n += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(data + i)), nl)));
+#endif
+
+            for (; i < length; i++)
+                n += data[i] == '\n';
+
+            return n;
+        }
+
+        /**
+         * @brief Scans the next token of a chunk and appends it to the chunk's token list. Returns `false` when the EOF token is
+         * reached (or an error was found).
+         * @param chunk 
+         * @return bool 
+         */
+        static bool step (Chunk *chunk)
+        {
+            Token *token = chunk->scanner->shiftToken();
+
+            if (chunk->count == chunk->capacity)
+            {
+                Token **tokens = new Token*[chunk->capacity *= 2];
+                unsigned long *offsets = new unsigned long[chunk->capacity];
+
+                memcpy (tokens, chunk->tokens, chunk->count*sizeof(Token*));
+                memcpy (offsets, chunk->offsets, chunk->count*sizeof(unsigned long));
+
+                delete[] chunk->tokens;
+                delete[] chunk->offsets;
+
+                chunk->tokens = tokens;
+                chunk->offsets = offsets;
+            }
+
+            chunk->tokens[chunk->count] = token;
+            chunk->offsets[chunk->count++] = chunk->scanner->offset - token->getLength();
+
+            return token->getType() != -1;
+        }
+
+        /**
+         * @brief Scans a chunk until a token that starts on the next chunk (or the EOF token) is found.
+         * @param chunk 
+         */
+        static void run (Chunk *chunk)
+        {
+            while (step(chunk) && chunk->offsets[chunk->count-1] < chunk->end);
+        }
+
+        /**
+         * @brief Deletes the tokens of a chunk in the given range.
+         * @param chunk 
+         * @param from 
+         * @param to 
+         */
+        static void discard (Chunk *chunk, int from, int to)
+        {
+            for (int i = from; i < to; i++)
+                delete chunk->tokens[i];
+        }
+
+        public:
+
+        /**
+         * @brief Initializes the scanner and scans the whole source.
+         * @param input Memory data provider.
+         * @param numThreads Number of threads to use (default is the number of hardware threads).
+         * @param stackSize Scanner stack size (default is 1024).
+         */
+        ParallelScanner (MemoryDataProvider *input, int numThreads=0, int stackSize=1024) : Scanner (input, stackSize)
+        {
+            const char *data = input->getData();
+            unsigned long length = input->getLength();
+            int numChunks = 0;
+
+            if (numThreads <= 0)
+                numThreads = std::thread::hardware_concurrency();
+
+            if (numThreads <= 0)
+                numThreads = 1;
+
+            if ((unsigned long)numThreads > length / MIN_CHUNK_SIZE)
+                numThreads = length / MIN_CHUNK_SIZE > 0 ? length / MIN_CHUNK_SIZE : 1;
+
+            // Split the source at the first newline after every nominal chunk boundary.
+            Chunk *chunks = new Chunk[numThreads];
+
+            for (int i = 0; i < numThreads; i++)
+            {
+                unsigned long start = i == 0 ? 0 : length / numThreads * i;
+
+                if (i != 0)
+                {
+                    const char *nl = (const char *)memchr (data + start, '\n', length - start);
+                    start = nl != nullptr ? nl - data + 1 : length;
+
+                    if (start <= chunks[numChunks-1].start || start == length)
+                        continue;
+                }
+
+                chunks[numChunks++].start = start;
+            }
+
+            for (int i = 0; i < numChunks; i++)
+                chunks[i].end = i + 1 < numChunks ? chunks[i+1].start : length;
+
+            // Count the newlines of every chunk to know the line where each one starts.
+            std::thread *threads = new std::thread[numChunks];
+
+            for (int i = 1; i < numChunks; i++)
+                threads[i] = std::thread ([chunks, data, i] { chunks[i].lines = countLines (data + chunks[i].start, chunks[i].end - chunks[i].start); });
+
+            chunks[0].lines = countLines (data, chunks[0].end);
+
+            for (int i = 1; i < numChunks; i++)
+                threads[i].join();
+
+#ifdef __scanner_$0_lazy_positions
+            // The line index is shared by the tokens of all chunks.
+            for (unsigned long j = 0; j < length; j += 1 << 30)
+                this->lines->scan (data + j, length - j < (1 << 30) ? length - j : 1 << 30, j);
+#endif
+
+            // Scan all chunks speculatively.
+            unsigned long line = 1;
+
+            for (int i = 0; i < numChunks; i++)
+            {
+                Chunk *chunk = &chunks[i];
+
+                chunk->input = new MemoryDataProvider (input->getName(), data + chunk->start, length - chunk->start);
+                chunk->scanner = new Scanner (chunk->input, stackSize);
+                chunk->scanner->setOrigin (chunk->start, line);
+                chunk->scanner->quiet = true;
+
+#ifdef __scanner_$0_lazy_positions
+                delete chunk->scanner->lines;
+                chunk->scanner->lines = this->lines;
+                chunk->scanner->ownsLines = false;
+#endif
+
+                chunk->tokens = new Token*[chunk->capacity = 256];
+                chunk->offsets = new unsigned long[chunk->capacity];
+                chunk->first = chunk->count = 0;
+
+                line += chunk->lines;
+
+                if (i != 0)
+                    threads[i] = std::thread (run, chunk);
+            }
+
+            run (&chunks[0]);
+
+            for (int i = 1; i < numChunks; i++)
+                threads[i].join();
+
+            // Verify the seams, the first chunk is always right. A chunk is accepted from the first token that starts at the same
+            // offset as a token of the current chunk, from there on both scanners are restarted at the same position and will
+            // produce the same tokens. Until then the current chunk keeps being scanned.
+            Chunk *current = &chunks[0];
+
+            for (int i = 1; i < numChunks; i++)
+            {
+                Chunk *next = &chunks[i];
+                int m = 0;
+
+                while (current->tokens[current->count-1]->getType() != -1)
+                {
+                    unsigned long offset = current->offsets[current->count-1];
+
+                    while (m < next->count && next->offsets[m] < offset)
+                        m++;
+
+                    if (m < next->count && next->offsets[m] == offset)
+                    {
+                        delete current->tokens[--current->count];
+                        current = next;
+                        break;
+                    }
+
+                    if (offset >= next->end)
+                        break;
+
+                    step (current);
+                }
+
+                if (current == next)
+                {
+                    discard (next, 0, m);
+                    next->first = m;
+                }
+                else
+                {
+                    discard (next, 0, next->count);
+                    next->count = 0;
+                }
+            }
+
+            // Report the error that the serial scanner would have reported.
+            if (current->offsets[current->count-1] != length)
+                printf ("error");
+
+            for (int i = 0; i < numChunks; i++)
+            {
+                for (int j = chunks[i].first; j < chunks[i].count; j++)
+                    this->queue->push (chunks[i].tokens[j]);
+
+                delete chunks[i].scanner;
+                delete chunks[i].input;
+                delete[] chunks[i].tokens;
+                delete[] chunks[i].offsets;
+            }
+
+            // Any further scan will only find the EOF.
+            input->seek (length);
+            setOrigin (length, line);
+
+            delete[] threads;
+            delete[] chunks;
+        }
+    };
+#endif
 };
 
 #endif
@@ -1,83 +1,188 @@
-
 #include <assert.h>
 #include <time.h>
 #include <stdlib.h>
 
+#include <atomic>
+#include <thread>
+#include <filesystem>
+
 #include "Parser"
 #include "itemsets/ItemSetBuilder"
 #include "states/FsmStateBuilder"
+#include "states/DfaBuilder"
 
 #include "gen/Cpp"
+#include "gen/CppRa"
+#include "gen/Bin"
 
 using namespace asr::utils;
 using namespace psxt;
 
 /**
- * @brief Entry point.
+ * @brief Settings and results of the generation of one grammar.
  */
-int main (int argc, char *argv[])
+struct Job
 {
-    List<String*> *sources = new List<String*> ();
-    String *fmt = new String("cpp"), *name = new String(""), *outdir = new String(""), *str;
-
-    bool dumpStates = false, dumpItemSets = false, generateCode = true;
-    const char *suffix;
+    /**
+     * @brief Source files, merged into a single context.
+     */
+    List<String*> *sources;
+
+    /**
+     * @brief Output format, base output name, output directory and directory of the dump files.
+     */
+    String *fmt, *name, *outdir, *dumpdir;
+
+    bool dumpStates, dumpItemSets, generateCode, failed;
+    ItemSetBuilder::Mode mode;
+    int options;
+
+    /**
+     * @brief Stream where errors and warnings are reported.
+     */
+    FILE *log;
+
+    /**
+     * @brief Number of states built.
+     */
+    int numScannerStates, numParserStates, numParserCores;
+
+    Job ()
+    {
+        sources = new List<String*> ();
+        fmt = new String("cpp");
+        name = new String("");
+        outdir = new String("");
+        dumpdir = new String("");
+
+        dumpStates = dumpItemSets = failed = false;
+        generateCode = true;
+        mode = ItemSetBuilder::Mode::DEFAULT;
+        options = 0;
+
+        log = stdout;
+        numScannerStates = numParserStates = numParserCores = 0;
+    }
 
-    printf ("Pegasus v5.00 Copyright (c) 2006-%d RedStar Technologies, All rights reserved.\n", 2024);
-    if (argc < 2)
+    /**
+     * @brief Creates a job with the settings of another one and no sources.
+     */
+    Job (Job *job) : Job ()
     {
-        printf (
-            "Syntax: psxt [options] sx-files\n\n"
-            "Options:\n"
-            "    -f xx    Set code generation output format.\n"
-            "    -n xx    Set base file output name.\n"
-            "    -o xx    Set output directory for the generated files.\n"
-            "    -d       Dump states.\n"
-            "    -i       Dump item sets.\n"
-            "\n"
-        );
+        fmt->set (job->fmt->c_str());
+        name->set (job->name->c_str());
 
-        return 1;
+        dumpStates = job->dumpStates;
+        dumpItemSets = job->dumpItemSets;
+        mode = job->mode;
+        options = job->options;
     }
 
-    printf ("\n");
+    ~Job ()
+    {
+        delete sources;
+        delete fmt;
+        delete name;
+        delete outdir;
+        delete dumpdir;
+
+        if (log != stdout)
+            fclose (log);
+    }
+};
 
-    for (int i = 1; i < argc; i++)
+/**
+ * @brief Applies the options of an argument list to a job, the remaining arguments are added as sources. The batch options
+ * are returned in `manifest` and `numThreads` when given.
+ */
+static void parseArgs (Job *job, int argc, char *argv[], const char **manifest, int *numThreads)
+{
+    for (int i = 0; i < argc; i++)
     {
         char *arg = argv[i];
         if (*arg == '-')
         {
             bool needsVal = true;
-            if (arg[1] == 'd' || arg[1] == 'i')
+            if (arg[1] == 'd' || arg[1] == 'i' || arg[1] == 'l' || arg[1] == 'p' || arg[1] == 'm' || arg[1] == 't')
                 needsVal = false;
 
-            char *val = needsVal ? (arg[2] != '\0' ? arg+2 : argv[++i]) : nullptr;
+            char *val = needsVal ? (arg[2] != '\0' ? arg+2 : (i+1 < argc ? argv[++i] : nullptr)) : nullptr;
+            if (needsVal && val == nullptr)
+                break;
+
             switch (arg[1])
             {
                 case 'f':
-                    fmt->set (val);
+                    job->fmt->set (val);
                     break;
 
                 case 'n':
-                    name->set (val);
+                    job->name->set (val);
                     break;
 
                 case 'd':
-                    dumpStates = true;
+                    job->dumpStates = true;
                     break;
 
                 case 'i':
-                    dumpItemSets = true;
+                    job->dumpItemSets = true;
+                    break;
+
+                case 'l':
+                    job->options |= Generator::Option::LAZY_POSITIONS;
+                    break;
+
+                case 'p':
+                    job->options |= Generator::Option::PARALLEL_SCAN;
+                    break;
+
+                case 'm':
+                    job->mode = ItemSetBuilder::Mode::MINIMAL_LR1;
+                    break;
+
+                case 't':
+                    job->options |= Generator::Option::SYNTAX_TREE;
                     break;
 
                 case 'o':
-                    outdir->set(val);
-                    if (outdir->charAt(-1) != '/' && outdir->charAt(-1) != '\\') outdir->append("/");
+                    job->outdir->set(val);
+                    if (job->outdir->charAt(-1) != '/' && job->outdir->charAt(-1) != '\\') job->outdir->append("/");
+                    break;
+
+                case 'b':
+                    if (manifest != nullptr) *manifest = val;
+                    break;
+
+                case 'j':
+                    if (numThreads != nullptr) *numThreads = atoi(val);
                     break;
             }
         }
         else
-            sources->push (new String (arg));
+            job->sources->push (new String (arg));
+    }
+}
+
+/**
+ * @brief Parses the sources of a job into a new context and generates its scanner and parser. Errors are reported to the
+ * stream of the job.
+ */
+static void build (Job *job)
+{
+    const char *suffix;
+    String *str;
+
+    errorStream = job->log;
+    errorCount = 0;
+
+    // The syntax tree is only built by the table-driven C++ parser.
+    if ((job->options & Generator::Option::SYNTAX_TREE) && (!strcmp(job->fmt->c_str(), "cpp-ra") || !strcmp(job->fmt->c_str(), "bin")))
+    {
+        fprintf (errorStream, "psxt: Option -t is not supported by the %s format.\n", job->fmt->c_str());
+
+        job->failed = true;
+        errorStream = stdout;
+        return;
     }
 
     // Prepare context to store the parsed sections and rules.
@@ -85,91 +190,124 @@ int main (int argc, char *argv[])
 
     // Parse all provided source files.
     Parser parser (context);
-    for (Linkable<String*> *i = sources->head(); i; i = i->next())
+    for (Linkable<String*> *i = job->sources->head(); i; i = i->next())
     {
         Scanner scanner (i->value);
         parser.parse(&scanner);
     }
 
-    // Use the C++ code generator.
+    // Select the code generator of the output format.
     Generator *generator;
-    generator = new gen::GeneratorCpp (context, suffix);
+    if (!strcmp(job->fmt->c_str(), "cpp-ra"))
+        generator = new gen::GeneratorCppRa (context, suffix);
+    else if (!strcmp(job->fmt->c_str(), "bin"))
+        generator = new gen::GeneratorBin (context, suffix);
+    else
+        generator = new gen::GeneratorCpp (context, suffix);
+    generator->setOptions (job->options);
 
 
     // ---------------------
     // Generate the scanner's itemsets, FSM states, and output code.
 
     LString *initialSymbol = LString::alloc("__start__");
-    int numScannerStates = 0, numParserStates = 0;
 
+    // Sections without rules are skipped, so a grammar may define only a scanner.
     LList<ItemSet*> *itemsets = ItemSetBuilder::build (context, Context::SectionType::LEXICON, initialSymbol);
-    if (itemsets != nullptr) {
-        numScannerStates = itemsets->length();
-        if (dumpItemSets) {
-            FILE *os = fopen("lexicon-itemsets.txt", "wb");
+    if (itemsets != nullptr)
+    {
+        job->numScannerStates = itemsets->length();
+        if (job->dumpItemSets) {
+            str = job->dumpdir->concat("lexicon-itemsets.txt");
+            FILE *os = fopen(str->c_str(), "wb");
             for (Linkable<ItemSet*> *i = itemsets->head(); i; i = i->next())
                 i->value->dump(os);
             fclose(os);
+            delete str;
         }
-    }
 
-    List<FsmState*> *states = FsmStateBuilder::build (context, Context::SectionType::LEXICON, itemsets->head()->value);
-    if (dumpStates) {
-        FILE *os = fopen("lexicon-states.txt", "wb");
-        for (Linkable<FsmState*> *i = states->head(); i; i = i->next())
-            i->value->dump(os);
-        fclose(os);
-    }
+        List<FsmState*> *states = FsmStateBuilder::build (context, Context::SectionType::LEXICON, itemsets->head()->value);
+        if (job->dumpStates) {
+            str = job->dumpdir->concat("lexicon-states.txt");
+            FILE *os = fopen(str->c_str(), "wb");
+            for (Linkable<FsmState*> *i = states->head(); i; i = i->next())
+                i->value->dump(os);
+            fclose(os);
+            delete str;
+        }
 
-    if (generateCode)
-    {
-        str = outdir->concat("scanner")->append(suffix);
-        FILE *os = fopen(str->c_str(), "wb");
-        if (os != nullptr)  {
-            generator->generate (states, Context::SectionType::LEXICON, os, name);
-            fclose (os);
+        // Regular tokens are scanned with a DFA, the LR states are used for the remaining ones.
+        Dfa *dfa = DfaBuilder::build (context);
+        if (dfa != nullptr && job->dumpStates) {
+            str = job->dumpdir->concat("lexicon-dfa.txt");
+            FILE *os = fopen(str->c_str(), "wb");
+            dfa->dump(os);
+            fclose(os);
+            delete str;
+        }
+
+        if (job->generateCode)
+        {
+            str = job->outdir->concat(generator->getOutputName(Context::SectionType::LEXICON))->append(suffix);
+            FILE *os = fopen(str->c_str(), "wb");
+            if (os != nullptr)  {
+                generator->setDfa (dfa);
+                generator->generate (states, Context::SectionType::LEXICON, os, job->name);
+                generator->setDfa (nullptr);
+                fclose (os);
+            }
+            delete str;
         }
-        delete str;
-    }
 
-    delete states->clear();
-    delete itemsets->clear();
+        if (dfa != nullptr)
+            delete dfa;
+
+        delete states->clear();
+        delete itemsets->clear();
+    }
 
     // ---------------------
     // Generate the parser's itemsets, FSM states, and output code.
 
-    itemsets = ItemSetBuilder::build (context, Context::SectionType::GRAMMAR, initialSymbol);
-    if (itemsets != nullptr) {
-        numParserStates = itemsets->length();
-        if (dumpItemSets) {
-            FILE *os = fopen("grammar-itemsets.txt", "wb");
+    itemsets = ItemSetBuilder::build (context, Context::SectionType::GRAMMAR, initialSymbol, job->mode);
+    if (itemsets != nullptr)
+    {
+        job->numParserStates = itemsets->length();
+        if (job->mode == ItemSetBuilder::Mode::MINIMAL_LR1)
+            job->numParserCores = ItemSetBuilder::countCores (itemsets);
+        if (job->dumpItemSets) {
+            str = job->dumpdir->concat("grammar-itemsets.txt");
+            FILE *os = fopen(str->c_str(), "wb");
             for (Linkable<ItemSet*> *i = itemsets->head(); i; i = i->next())
                 i->value->dump(os);
             fclose(os);
+            delete str;
         }
-    }
 
-    states = FsmStateBuilder::build (context, Context::SectionType::GRAMMAR, itemsets->head()->value);
-    if (dumpStates) {
-        FILE *os = fopen("grammar-states.txt", "wb");
-        for (Linkable<FsmState*> *i = states->head(); i; i = i->next())
-            i->value->dump(os);
-        fclose(os);
-    }
+        List<FsmState*> *states = FsmStateBuilder::build (context, Context::SectionType::GRAMMAR, itemsets->head()->value);
+        if (job->dumpStates) {
+            str = job->dumpdir->concat("grammar-states.txt");
+            FILE *os = fopen(str->c_str(), "wb");
+            for (Linkable<FsmState*> *i = states->head(); i; i = i->next())
+                i->value->dump(os);
+            fclose(os);
+            delete str;
+        }
 
-    if (generateCode)
-    {
-        str = outdir->concat("parser")->append(suffix);
-        FILE *os = fopen(str->c_str(), "wb");
-        if (os != nullptr)  {
-            generator->generate (states, Context::SectionType::GRAMMAR, os, name);
-            fclose (os);
+        if (job->generateCode)
+        {
+            str = job->outdir->concat(generator->getOutputName(Context::SectionType::GRAMMAR))->append(suffix);
+            FILE *os = fopen(str->c_str(), "wb");
+            if (os != nullptr)  {
+                generator->generate (states, Context::SectionType::GRAMMAR, os, job->name);
+                fclose (os);
+            }
+            delete str;
         }
-        delete str;
-    }
 
-    delete states->clear();
-    delete itemsets->clear();
+        delete states->clear();
+        delete itemsets->clear();
+    }
 
     // ---------------------
     // Clean up everything.
@@ -177,23 +315,213 @@ int main (int argc, char *argv[])
     initialSymbol->free();
 
     delete generator;
-    delete sources;
     delete context;
-    delete name;
-    delete outdir;
-    delete fmt;
+
+    if (errorCount != 0)
+        job->failed = true;
+
+    errorStream = stdout;
+}
+
+/**
+ * @brief Prints the number of states built for a job.
+ */
+static void report (Job *job)
+{
+    if (job->numScannerStates && job->numParserStates)
+        printf ("psxt: Generated %u scanner states, and %u parser states.\n", job->numScannerStates, job->numParserStates);
+    else if (job->numScannerStates)
+        printf ("psxt: Generated %u scanner states.\n", job->numScannerStates);
+    else if (job->numParserStates)
+        printf ("psxt: Generated %u parser states.\n", job->numParserStates);
+
+    if (job->numParserCores)
+        printf ("psxt: Minimal LR(1) built %u parser states, LALR(1) would build %u.\n", job->numParserStates, job->numParserCores);
+}
+
+/**
+ * @brief Builds the grammars listed in a manifest on a pool of threads. Every line of the manifest holds the options and
+ * sources of one grammar, with the command line options as defaults. Grammars are built in separate contexts, each one in
+ * its own output directory (the `-o` of the line or the name of its first source, under the command line `-o`). The errors
+ * of each grammar are collected apart and printed in the order of the manifest once all of them are built.
+ */
+static int batch (Job *defaults, const char *manifest, int numThreads)
+{
+    FILE *fp = fopen(manifest, "rb");
+    if (fp == nullptr)
+    {
+        printf ("psxt: Unable to open manifest: %s\n", manifest);
+        return 1;
+    }
+
+    List<Job*> *jobs = new List<Job*> ();
+    char line[4096];
+
+    while (fgets(line, sizeof(line), fp) != nullptr)
+    {
+        char *args[256], *s;
+        int argc = 0;
+
+        for (s = strtok(line, " \t\r\n"); s != nullptr && argc < 256; s = strtok(nullptr, " \t\r\n"))
+            args[argc++] = s;
+
+        if (argc == 0 || *args[0] == '#')
+            continue;
+
+        Job *job = new Job (defaults);
+        parseArgs (job, argc, args, nullptr, nullptr);
+
+        if (job->sources->length() == 0)
+        {
+            printf ("psxt: No sources in manifest line: %s\n", args[0]);
+            delete job;
+            continue;
+        }
+
+        // Without an output directory the grammar is named after its first source.
+        if (job->outdir->length == 0)
+        {
+            job->outdir->set(std::filesystem::path(job->sources->first()->c_str()).stem().string().c_str());
+            job->outdir->append("/");
+        }
+
+        String *str = defaults->outdir->concat(job->outdir->c_str());
+        job->outdir->set(str->c_str());
+        delete str;
+
+        std::error_code error;
+        std::filesystem::create_directories (job->outdir->c_str(), error);
+
+        job->dumpdir->set(job->outdir->c_str());
+        job->log = tmpfile();
+        if (job->log == nullptr) job->log = stdout;
+
+        jobs->push (job);
+    }
+
+    fclose (fp);
+
+    Job **list = new Job*[jobs->length() + 1];
+    int numJobs = 0, status = 0;
+
+    for (Linkable<Job*> *i = jobs->head(); i; i = i->next())
+        list[numJobs++] = i->value;
+
+    if (numThreads <= 0)
+        numThreads = std::thread::hardware_concurrency();
+    if (numThreads <= 0)
+        numThreads = 1;
+    if (numThreads > numJobs)
+        numThreads = numJobs;
+
+    // Workers take the next grammar until none is left, every thread has its own string pool.
+    std::atomic<int> next (0);
+    std::thread *threads = new std::thread[numThreads];
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        threads[i] = std::thread ([list, numJobs, &next]
+        {
+            for (int j = next++; j < numJobs; j = next++)
+                build (list[j]);
+
+            LString::clear();
+        });
+    }
+
+    for (int i = 0; i < numThreads; i++)
+        threads[i].join();
+
+    delete[] threads;
+
+    for (int i = 0; i < numJobs; i++)
+    {
+        Job *job = list[i];
+
+        printf ("psxt: %s\n", job->outdir->c_str());
+
+        if (job->log != stdout)
+        {
+            rewind (job->log);
+
+            size_t n;
+            while ((n = fread(line, 1, sizeof(line), job->log)) > 0)
+                fwrite (line, 1, n, stdout);
+        }
+
+        report (job);
+        printf ("\n");
+
+        if (job->failed)
+            status = 1;
+
+        delete job;
+    }
+
+    delete[] list;
+    delete jobs;
+
+    return status;
+}
+
+/**
+ * @brief Entry point.
+ */
+int main (int argc, char *argv[])
+{
+    const char *manifest = nullptr;
+    int numThreads = 0;
+
+    printf ("Pegasus v5.00 Copyright (c) 2006-%d RedStar Technologies, All rights reserved.\n", 2024);
+    if (argc < 2)
+    {
+        printf (
+            "Syntax: psxt [options] sx-files\n"
+            "        psxt [options] -b manifest\n\n"
+            "Options:\n"
+            "    -f xx    Set code generation output format (cpp, cpp-ra for a recursive-ascent parser, or bin for binary tables).\n"
+            "    -n xx    Set base file output name.\n"
+            "    -o xx    Set output directory for the generated files.\n"
+            "    -d       Dump states.\n"
+            "    -i       Dump item sets.\n"
+            "    -l       Store token positions as byte offsets, line and column are computed on demand.\n"
+            "    -p       Generate a multi-threaded scanner for in-memory sources.\n"
+            "    -m       Build minimal LR(1) parser states, lookaheads are used to choose reductions.\n"
+            "    -t       Generate a parser that builds a flat syntax tree instead of running the rule actions (cpp format).\n"
+            "    -b xx    Build the grammars listed in a manifest, one per line with its own options and sources.\n"
+            "    -j xx    Set the number of threads used to build the grammars of a manifest (default is one per core).\n"
+            "\n"
+        );
+
+        return 1;
+    }
+
+    printf ("\n");
+
+    Job *job = new Job ();
+    parseArgs (job, argc-1, argv+1, &manifest, &numThreads);
+
+    if (manifest != nullptr)
+    {
+        int status = batch (job, manifest, numThreads);
+
+        delete job;
+        LString::finish();
+
+        return status;
+    }
+
+    build (job);
 
     LString::finish();
 
-    if (numScannerStates && numParserStates)
-        printf ("psxt: Generated %u scanner states, and %u parser states.\n", numScannerStates, numParserStates);
-    else if (numScannerStates)
-        printf ("psxt: Generated %u scanner states.\n", numScannerStates);
-    else if (numParserStates)
-        printf ("psxt: Generated %u parser states.\n", numParserStates);
+    report (job);
+
+    int status = job->failed ? 1 : 0;
+    delete job;
 
     if (asr::memblocks)
         printf ("\n\x1B[93mWarning:\x1B[0m Possible memory leak detected, left %u blocks wandering.\n", asr::memblocks);
 
-    return 0;
+    return status;
 }